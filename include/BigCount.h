@@ -0,0 +1,110 @@
+#ifndef BIG_COUNT_H
+#define BIG_COUNT_H
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// 精确的非负整数计数。不超过 64 位时只用内联的 small_，加法与乘法用溢出检测内建函数一条分支完成；
+// 溢出后提升为堆上的 64 位 limb 数组（低位在前），此后按大整数运算，结果不会再被近似。
+// big_ 非空当且仅当值不小于 2^64；对象本身只有 small_ 与一个指针共 16 字节，缓存条目中的计数保持紧凑。
+// 两个大整数之间赋值时复用已有 limb 数组的容量。
+class BigCount {
+    public:
+        BigCount() : small_(0) {}
+        BigCount(uint64_t v) : small_(v) {}
+        BigCount(const BigCount& o) : small_(o.small_), big_(o.big_ ? new std::vector<uint64_t>(*o.big_) : nullptr) {}
+        BigCount(BigCount&&) noexcept = default;
+        BigCount& operator=(const BigCount& o) {
+            small_ = o.small_;
+            if (!o.big_) big_.reset();
+            else if (big_) *big_ = *o.big_;
+            else big_.reset(new std::vector<uint64_t>(*o.big_));
+            return *this;
+        }
+        BigCount& operator=(BigCount&&) noexcept = default;
+
+        bool isZero() const { return !big_ && small_ == 0; }
+        bool isFailure() const { return isZero(); }
+        bool fitsU64() const { return !big_; }
+        // 值不超过 64 位时的数值
+        uint64_t low() const { return small_; }
+        size_t limbCount() const { return big_ ? big_->size() : 1; }
+
+        std::string toString() const;
+        // 以 10 为底的对数，值为 0 时返回 -inf
+        double log10() const;
+
+        BigCount& operator+=(const BigCount& o) {
+            uint64_t s;
+            if (!big_ && !o.big_ && !__builtin_add_overflow(small_, o.small_, &s)) {
+                small_ = s;
+                return *this;
+            }
+            addSlow(o);
+            return *this;
+        }
+
+        BigCount& operator*=(const BigCount& o) {
+            uint64_t p;
+            if (!big_ && !o.big_ && !__builtin_mul_overflow(small_, o.small_, &p)) {
+                small_ = p;
+                return *this;
+            }
+            mulSlow(o);
+            return *this;
+        }
+
+        // 要求 *this >= o
+        BigCount& operator-=(const BigCount& o);
+
+        friend BigCount operator+(BigCount a, const BigCount& b) { return a += b; }
+        friend BigCount operator*(BigCount a, const BigCount& b) { return a *= b; }
+        friend BigCount operator-(BigCount a, const BigCount& b) { return a -= b; }
+
+        friend bool operator==(const BigCount& a, const BigCount& b) {
+            return a.big_ ? (b.big_ && *a.big_ == *b.big_) : (!b.big_ && a.small_ == b.small_);
+        }
+        friend bool operator!=(const BigCount& a, const BigCount& b) { return !(a == b); }
+        friend bool operator<(const BigCount& a, const BigCount& b) { return compare(a, b) < 0; }
+        friend bool operator>=(const BigCount& a, const BigCount& b) { return compare(a, b) >= 0; }
+
+        static int compare(const BigCount& a, const BigCount& b);
+
+        // [0, bound) 内的均匀随机数，bound 须大于 0；大整数按位长抽取后拒绝采样，期望不超过两次
+        template <typename Rng>
+        static BigCount uniformBelow(const BigCount& bound, Rng& rng) {
+            if (!bound.big_) {
+                return BigCount(std::uniform_int_distribution<uint64_t>(0, bound.small_ - 1)(rng));
+            }
+            const std::vector<uint64_t>& b = *bound.big_;
+            const size_t n = b.size();
+            const uint64_t mask = ~uint64_t(0) >> __builtin_clzll(b.back());
+            BigCount r;
+            r.big_.reset(new std::vector<uint64_t>(n));
+            std::vector<uint64_t>& l = *r.big_;
+            do {
+                for (size_t i = 0; i < n; i++) l[i] = static_cast<uint64_t>(rng());
+                l.back() &= mask;
+            } while (compareLimbs(l, b) >= 0);
+            r.normalize();
+            return r;
+        }
+
+    private:
+        uint64_t small_;                               // 值小于 2^64 时的数值
+        std::unique_ptr<std::vector<uint64_t>> big_;   // 值不小于 2^64 时的 limb 数组
+
+        void addSlow(const BigCount& o);
+        void mulSlow(const BigCount& o);
+        // 去掉高位的 0 limb，不足两个 limb 时退回内联表示
+        void normalize();
+        // 转为 limb 数组（至少一个 limb）
+        void promote();
+
+        static int compareLimbs(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b);
+};
+
+#endif // BIG_COUNT_H
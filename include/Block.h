@@ -5,41 +5,206 @@
 #include <bits/stdc++.h>
 using namespace std;
 
+// 稀疏集合（dense 数组 + 位置索引），元素为非负整数
+// dense[0, n) 为当前元素，dense[n, ...) 为已删除的元素；pos[x] 为 x 在 dense 中的下标。
+// 删除时把元素交换到活跃区末尾，恢复时再交换回活跃区末尾，二者均为 O(1)，
+// 恢复顺序不必与删除顺序相反；遍历的是连续内存，但顺序不保证有序。
+class SparseSet {
+    public:
+        using const_iterator = vector<int>::const_iterator;
+
+        SparseSet() = default;
+
+        template <typename Container>
+        explicit SparseSet(const Container& c) {
+            int maxElem = -1;
+            for (int x : c) maxElem = std::max(maxElem, x);
+            pos.assign(static_cast<size_t>(maxElem + 1), NPOS);
+            dense.reserve(c.size());
+            for (int x : c) insert(x);
+        }
+
+        const_iterator begin() const { return dense.begin(); }
+        const_iterator end() const { return dense.begin() + n; }
+
+        size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+
+        bool contains(int x) const {
+            return x >= 0 && static_cast<size_t>(x) < pos.size() && pos[x] < n;
+        }
+
+        // 删除 x，x 不在集合中时不做任何事
+        bool erase(int x) {
+            if (!contains(x)) return false;
+            uint32_t p = pos[x];
+            uint32_t last = static_cast<uint32_t>(n - 1);
+            swapSlots(p, last);
+            n--;
+            return true;
+        }
+
+        // 加入 x：已删除的元素原位恢复，首次出现的元素追加到 dense 末尾
+        bool insert(int x) {
+            if (static_cast<size_t>(x) >= pos.size()) pos.resize(static_cast<size_t>(x) + 1, NPOS);
+            if (pos[x] == NPOS) {
+                pos[x] = static_cast<uint32_t>(dense.size());
+                dense.push_back(x);
+            }
+            if (pos[x] < n) return false;
+            swapSlots(pos[x], static_cast<uint32_t>(n));
+            n++;
+            return true;
+        }
+
+    private:
+        static constexpr uint32_t NPOS = UINT32_MAX;
+
+        vector<int> dense;
+        vector<uint32_t> pos;
+        size_t n = 0;
+
+        void swapSlots(uint32_t a, uint32_t b) {
+            int xa = dense[a], xb = dense[b];
+            dense[a] = xb; pos[xb] = a;
+            dense[b] = xa; pos[xa] = b;
+        }
+};
+
+// 按列大小分桶的最小列队列，每个块各自维护一份
+// 每个桶是带哨兵的双向循环链表（节点 0..maxCol 为列，其后为各大小的哨兵），
+// 列大小加减一、列的移除与恢复均为 O(1)，最小桶下标惰性上移，取最小列为均摊 O(1)。
+// 列号可以不连续，0..maxCol 中不属于块的列不在任何桶中，对它们的更新直接忽略。
+class ColumnBuckets {
+    public:
+        bool ready() const { return !next.empty(); }
+
+        // 以当前列大小建立队列，同一桶内按列号升序
+        void build(const SparseSet& cols, const int* colSize) {
+            vector<int> ids(cols.begin(), cols.end());
+            sort(ids.begin(), ids.end());
+            maxCol = ids.empty() ? 0 : ids.back();
+
+            int maxSize = 0;
+            for (int c : ids) maxSize = std::max(maxSize, colSize[c]);
+
+            size.assign(static_cast<size_t>(maxCol) + 1, 0);
+            member.assign(static_cast<size_t>(maxCol) + 1, 0);
+            next.resize(static_cast<size_t>(maxCol) + 1);
+            prev.resize(static_cast<size_t>(maxCol) + 1);
+            for (int c = 0; c <= maxCol; c++) next[c] = prev[c] = c;  // 非块列为自环
+            buckets = 0;
+            growBuckets(maxSize);
+
+            minSize = maxSize;
+            for (int c : ids) {
+                member[c] = 1;
+                size[c] = colSize[c];
+                link(c, size[c]);
+                minSize = std::min(minSize, size[c]);
+            }
+        }
+
+        // 当前大小最小的列，队列为空时返回 -1
+        int top() {
+            while (minSize < buckets && next[head(minSize)] == head(minSize)) minSize++;
+            return minSize < buckets ? next[head(minSize)] : -1;
+        }
+
+        void decrease(int c) {
+            if (!tracks(c)) return;
+            unlink(c);
+            link(c, --size[c]);
+            if (size[c] < minSize) minSize = size[c];
+        }
+
+        void increase(int c) {
+            if (!tracks(c)) return;
+            unlink(c);
+            if (++size[c] >= buckets) growBuckets(size[c]);
+            link(c, size[c]);
+        }
+
+        // 列被覆盖时移出队列；被移出期间该列大小不会变化
+        void remove(int c) {
+            if (!tracks(c)) return;
+            unlink(c);
+        }
+
+        void restore(int c) {
+            if (!tracks(c)) return;
+            link(c, size[c]);
+            if (size[c] < minSize) minSize = size[c];
+        }
+
+    private:
+        vector<int> next, prev;  // 列节点与桶哨兵共用的链接
+        vector<int> size;        // 队列记录的列大小
+        vector<uint8_t> member;  // 列是否属于建立队列时的块
+        int maxCol = 0;
+        int buckets = 0;         // 桶数，即最大列大小 + 1
+        int minSize = 0;
+
+        int head(int s) const { return maxCol + 1 + s; }
+        bool tracks(int c) const { return c >= 0 && c <= maxCol && member[c]; }
+
+        void growBuckets(int maxSize) {
+            while (buckets <= maxSize) {
+                int h = head(buckets++);
+                next.push_back(h);
+                prev.push_back(h);
+            }
+        }
+
+        void link(int c, int s) {
+            int h = head(s);
+            prev[c] = prev[h];
+            next[c] = h;
+            next[prev[h]] = c;
+            prev[h] = c;
+        }
+
+        void unlink(int c) {
+            next[prev[c]] = next[c];
+            prev[next[c]] = prev[c];
+        }
+};
+
 struct Block {
-    set<int> rows;  // 舞蹈链行id集合 
-    set<int> cols;  // 从1开始编号,对应舞蹈链列数id
+    SparseSet rows;  // 舞蹈链行id集合
+    SparseSet cols;  // 从1开始编号,对应舞蹈链列数id
+    ColumnBuckets colQueue;  // 块内列的最小大小队列，首次选列时建立
+    uint64_t stateHash = 0;  // 当前列集合的 Zobrist 哈希，覆盖/恢复列时异或更新
     bool is_spilited = false;
-    
+
     Block() = default;
 
     size_t size() const { return rows.size(); }
 
-    Block(set<int> r, set<int> c) : rows(move(r)), cols(move(c)) {}
-
     template <typename RowsContainer, typename ColsContainer>
     Block(const RowsContainer& r, const ColsContainer& c)
-        : rows(r.begin(), r.end()), cols(c.begin(), c.end()) {}
-
-    Block(const Block& other) {
-        cols = other.cols;
-        rows = other.rows;
-    };
+        : rows(r), cols(c) {}
 
     void printBlock(int block_id) {
         if (rows.empty() || cols.empty()) return;
         cout << "Block " << block_id << ": { ";
 
+        vector<int> sortedCols(cols.begin(), cols.end());
+        vector<int> sortedRows(rows.begin(), rows.end());
+        sort(sortedCols.begin(), sortedCols.end());
+        sort(sortedRows.begin(), sortedRows.end());
+
         cout<< "cols: [ ";
-        for(int c : cols){
+        for(int c : sortedCols){
             cout << c << " ";
         }
         cout << "], ";
         cout<< "rows: [ ";
-        for(int r : rows){
+        for(int r : sortedRows){
             cout<< r << " ";
         }
         cout << "] }" << endl;
     }
 };
 
-#endif // BLOCK_H
\ No newline at end of file
+#endif // BLOCK_H
@@ -36,7 +36,7 @@ struct EdgeInfo {
     EdgeInfo(int lvl = 0, bool tree = false) : level(lvl), is_tree(tree) {}
 };
 
-// 分层非树边存储结构
+// 分层非树边存储结构（仅供 ComponentDetector 使用；DancingMatrix 的 ETT 分层见 splaytree::EulerTourTree::upperLevels）
 struct LayeredNonTreeEdges {
     std::vector<std::unordered_set<unsigned long long>> levels;  // levels[i] = 第i层的非树边集合
     std::unordered_map<unsigned long long, int> edge_to_level;   // 边 -> 当前所在层级
@@ -360,32 +360,71 @@ public:
 
 };
 
-// 邻接表节点（支持O(1)删除和恢复）
-struct AdjNode {
-    int neighbor;
-    bool deleted;
-    AdjNode* next;
-    
-    AdjNode(int v) : neighbor(v), deleted(false), next(nullptr) {}
-};
-
 struct Vertex {
     bool     deleted = false;
     int      compId  = -1;    // 路由键：所属连通分量 ID
-    AdjNode  sentinel{-1};    // 邻接表哨兵头（不存储真实数据）
+};
+
+// 一段连续存放的顶点编号（CSR 邻居数组或分量顶点表的切片），遍历时不分配内存。
+// deleted 非空时跳过位图中已删除的槽位（slot 为首元素的槽位号），verts 非空时跳过已删除的顶点。
+class VertexRange {
+public:
+    class iterator {
+    public:
+        iterator(const VertexRange* r, const int* p) : r_(r), p_(p) { skip(); }
+        int operator*() const { return *p_; }
+        iterator& operator++() { ++p_; skip(); return *this; }
+        bool operator!=(const iterator& o) const { return p_ != o.p_; }
+        bool operator==(const iterator& o) const { return p_ == o.p_; }
+    private:
+        const VertexRange* r_;
+        const int* p_;
+        void skip() { while (p_ != r_->last_ && !r_->live(p_)) ++p_; }
+    };
+
+    VertexRange(const int* first, const int* last, uint32_t slot = 0,
+                const std::atomic<uint64_t>* deleted = nullptr, const Vertex* verts = nullptr)
+        : first_(first), last_(last), slot_(slot), deleted_(deleted), verts_(verts) {}
+
+    iterator begin() const { return iterator(this, first_); }
+    iterator end()   const { return iterator(this, last_); }
+
+    // 过滤后的元素个数，O(区间长度)
+    size_t size() const {
+        size_t n = 0;
+        for (const int* p = first_; p != last_; ++p) n += live(p);
+        return n;
+    }
+    bool empty() const { return !(begin() != end()); }
+
+private:
+    const int* first_;
+    const int* last_;
+    uint32_t slot_;
+    const std::atomic<uint64_t>* deleted_;
+    const Vertex* verts_;
+
+    bool live(const int* p) const {
+        if (deleted_) {
+            uint32_t s = slot_ + static_cast<uint32_t>(p - first_);
+            if (deleted_[s >> 6].load(std::memory_order_relaxed) >> (s & 63) & 1) return false;
+        }
+        return !verts_ || !verts_[*p].deleted;
+    }
 };
 
 class Graph;
 
+// 一个连通分量在主图上的视图：顶点表是主图分量顶点数组中的一段，边操作全部委托给主图，不复制任何数据
 class SubGraph {
 public:
-    SubGraph(Graph* parent, int compId, std::vector<int> vids)
-        : parent_(parent), compId_(compId), vertexIds_(std::move(vids)) {}
+    SubGraph(Graph* parent, int compId, size_t offset, size_t count)
+        : parent_(parent), compId_(compId), offset_(offset), count_(count) {}
 
     // ── 元信息 ──────────────────────────────
     int compId()  const { return compId_; }
-    int size()    const { return (int)vertexIds_.size(); }
-    const std::vector<int>& vertices() const { return vertexIds_; }
+    int size()    const { return (int)count_; }
+    VertexRange vertices() const;
 
     // ── 无锁边/顶点操作（委托给父图内存）──
     void addEdge    (int u, int v);
@@ -396,30 +435,28 @@ public:
     void restoreVertex(int v);
     bool hasVertex  (int v)        const;
 
-    // neighbors：返回活跃边的邻居
-    std::vector<int> neighbors(int v) const;
+    // neighbors：活跃边的邻居
+    VertexRange neighbors(int v) const;
 
-    std::vector<int> getAllNeighbors(int v) const;
+    // 全部邻居，含已删除的边
+    VertexRange getAllNeighbors(int v) const;
 
     void print() const;
 
 private:
     Graph*           parent_;
     int              compId_;
-    std::vector<int> vertexIds_;
+    size_t           offset_;
+    size_t           count_;
 };
 
-// Graph —— 主图（持有所有顶点和邻接表内存）
+// Graph —— 主图（持有所有顶点和邻接内存）
+// 建图阶段 addEdge 只记录边，finalize() 后转为 CSR：offsets_[v] .. offsets_[v+1] 为 v 的邻居，升序排列；
+// 每条无向边在两端各占一个槽位，删除/恢复只翻转两个槽位在 deleted_ 位图中的位，查找边为二分查找。
+// 位图按 64 位字原子更新：mdxd 中各线程处理不同分量，但相邻顶点的槽位可能落在同一个字里。
 class Graph {
 public:
-    explicit Graph(int n) : vertices_(n), vertexComp_(n, -1) {}
-
-    ~Graph() {
-        for (auto& v : vertices_) {
-            AdjNode* cur = v.sentinel.next;
-            while (cur) { AdjNode* nxt = cur->next; delete cur; cur = nxt; }
-        }
-    }
+    explicit Graph(int n) : vertices_(n), vertexComp_(n, -1), offsets_(n + 1, 0) {}
     
     // ── 顶点操作 ────────────────────────────
     void addVertex    (int v) { chk(v); vertices_[v].deleted = false; }
@@ -428,35 +465,33 @@ public:
     bool hasVertex    (int v) const { chk(v); return !vertices_[v].deleted; }
 
     // ── 边操作 ──────────────────────────────
-    void addEdge    (int u, int v) { insertDir(u,v); insertDir(v,u); }
-    void deleteEdge (int u, int v) { markDir(u,v,true);  markDir(v,u,true);  }
-    void restoreEdge(int u, int v) { markDir(u,v,false); markDir(v,u,false); }
+    // finalize 之前只记录边；之后加入已有的边等同于恢复，加入新边会重建 CSR（不在热路径上）
+    void addEdge    (int u, int v);
+    // 由已记录的边建立 CSR，重复边只保留一条
+    void finalize();
+    void deleteEdge (int u, int v) { markSlot(slotOf(u,v), true);  markSlot(slotOf(v,u), true);  }
+    void restoreEdge(int u, int v) { markSlot(slotOf(u,v), false); markSlot(slotOf(v,u), false); }
     bool hasEdge    (int u, int v) const {
-        AdjNode* n = findNode(u,v); return n && !n->deleted;
+        int s = slotOf(u, v); return s >= 0 && !slotDeleted(s);
     }
 
-    std::vector<int> neighbors(int v) const {
-        chk(v);
-        std::vector<int> res;
-        for (AdjNode* c = vertices_[v].sentinel.next; c; c = c->next)
-            if (!c->deleted && !vertices_[c->neighbor].deleted)
-                res.push_back(c->neighbor);
-        return res;
-    }
+    VertexRange neighbors(int v) const { return getNeighbors(v); }
 
     int numVertices()   const { return (int)vertices_.size(); }
     int numComponents() const { return (int)subgraphs_.size(); }
+    size_t numEdges()   const { return adj_.size() / 2; }
 
     void registerComponent(int compId,
                            const std::unordered_set<int>& comp_vertices)
     {
-        std::vector<int> vids(comp_vertices.begin(), comp_vertices.end());
-        for (int v : vids) {
+        size_t offset = compVertices_.size();
+        for (int v : comp_vertices) {
             vertexComp_[v]      = compId;
             vertices_[v].compId = compId;
+            compVertices_.push_back(v);
         }
         subgraphs_[compId] = std::make_unique<SubGraph>(
-            this, compId, std::move(vids));
+            this, compId, offset, comp_vertices.size());
     }
 
     SubGraph* subgraphOf(int v) const {
@@ -479,20 +514,36 @@ public:
     Vertex&       vertex(int v)       { return vertices_[v]; }
     const Vertex& vertex(int v) const { return vertices_[v]; }
 
-    AdjNode* findNode(int u, int v) const {
+    // 边 u->v 在 CSR 中的槽位，不存在时返回 -1
+    int slotOf(int u, int v) const {
         if (u < 0 || u >= (int)vertices_.size()) {
-            fprintf(stderr, "[ERROR] findNode: u=%d, size=%zu\n", u, vertices_.size());
+            fprintf(stderr, "[ERROR] slotOf: u=%d, size=%zu\n", u, vertices_.size());
             abort(); // 让 ASan 给出更清晰的栈信息
         }
-        for (AdjNode* c = vertices_[u].sentinel.next; c; c = c->next)
-            if (c->neighbor == v) return c;
-        return nullptr;
+        const int* first = adj_.data() + offsets_[u];
+        const int* last  = adj_.data() + offsets_[u + 1];
+        const int* it = std::lower_bound(first, last, v);
+        return (it != last && *it == v) ? (int)(it - adj_.data()) : -1;
+    }
+    bool slotDeleted(int s) const {
+        return deleted_[s >> 6].load(std::memory_order_relaxed) >> (s & 63) & 1;
     }
     
-    std::vector<int> getNeighbors(int v) const;
-    std::vector<int> getAllNeighbors(int v) const;
-    // bool hasEdge(int u, int v) const;
-    int getDegree(int v) const;
+    // 活跃邻居（边未删除且邻居顶点未删除）
+    VertexRange getNeighbors(int v) const {
+        return VertexRange(adj_.data() + offsets_[v], adj_.data() + offsets_[v + 1],
+                           offsets_[v], deleted_.get(), vertices_.data());
+    }
+    // 全部邻居，不检查删除标记
+    VertexRange getAllNeighbors(int v) const {
+        return VertexRange(adj_.data() + offsets_[v], adj_.data() + offsets_[v + 1]);
+    }
+    int getDegree(int v) const { return (int)getNeighbors(v).size(); }
+
+    // 分量顶点表的一段，供 SubGraph 使用
+    VertexRange componentVertices(size_t offset, size_t count) const {
+        return VertexRange(compVertices_.data() + offset, compVertices_.data() + offset + count);
+    }
 
     void printGraph() const {
         std::cout << "── Graph "
@@ -504,9 +555,9 @@ public:
                       << (vt.deleted ? "[D]" : "   ")
                       << " c" << std::setw(2) << vt.compId << " │ ";
             
-            for (AdjNode* c = vt.sentinel.next; c; c = c->next) {
-                std::cout << c->neighbor;
-                if (c->deleted) std::cout << "✗";
+            for (uint32_t s = offsets_[i]; s < offsets_[i + 1]; s++) {
+                std::cout << adj_[s];
+                if (slotDeleted(s)) std::cout << "✗";
                 std::cout << " ";
             }
             std::cout << "\n";
@@ -516,26 +567,23 @@ public:
     }
 
 private:
-    // int numVertices;
-    std::vector<AdjNode*> adjList;  // 每个顶点的邻接表头
-    std::unordered_map<int, std::unordered_map<int, AdjNode*>> edgeMap; // 快速查找边
-
     std::vector<Vertex>   vertices_;
     std::vector<int>      vertexComp_;   // 路由表：vertex_id → comp_id  (O(1))
     std::unordered_map<int, std::unique_ptr<SubGraph>> subgraphs_; // comp_id → SubGraph
+    std::vector<int>      compVertices_; // 各分量的顶点按分量依次存放
+
+    std::vector<uint32_t> offsets_;      // CSR 行偏移，长度 n + 1
+    std::vector<int>      adj_;          // 各顶点的邻居，段内升序
+    std::unique_ptr<std::atomic<uint64_t>[]> deleted_;  // 每个槽位一位，置位表示边已删除
+    std::vector<std::pair<int, int>> pending_;          // 建图阶段记录的边
 
     void chk(int v) const { assert(v >= 0 && v < (int)vertices_.size()); }
 
-    void insertDir(int u, int v) {
-        AdjNode* node = findNode(u, v);
-        if (node) { node->deleted = false; return; }
-        AdjNode* n = new AdjNode(v);
-        n->next    = vertices_[u].sentinel.next;
-        vertices_[u].sentinel.next = n;
-    }
-    void markDir(int u, int v, bool del) {
-        AdjNode* node = findNode(u, v);
-        if (node) node->deleted = del;
+    void markSlot(int s, bool del) {
+        if (s < 0) return;
+        uint64_t bit = uint64_t(1) << (s & 63);
+        if (del) deleted_[s >> 6].fetch_or(bit, std::memory_order_relaxed);
+        else     deleted_[s >> 6].fetch_and(~bit, std::memory_order_relaxed);
     }
 };
 
@@ -0,0 +1,105 @@
+#ifndef COUNT_H
+#define COUNT_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+#include "BigCount.h"
+#include "ModCount.h"
+
+// 对数域计数：只保存 log2(值) 一个 double，共 8 字节。乘法即对数相加，加法为 log-sum-exp，
+// 没有循环规范化；结果是约 15 位有效数字的近似值，不小于 2^53 时按科学计数法输出。
+class LogRep {
+    public:
+        LogRep() : lg_(-std::numeric_limits<double>::infinity()) {}
+        LogRep(uint64_t v)
+            : lg_(v ? std::log2(static_cast<double>(v)) : -std::numeric_limits<double>::infinity()) {}
+
+        bool isZero() const { return lg_ == -std::numeric_limits<double>::infinity(); }
+        double log2() const { return lg_; }
+        double log10() const { return lg_ * 0.30102999566398119521; }
+
+        LogRep& operator+=(const LogRep& o) {
+            double hi = lg_ > o.lg_ ? lg_ : o.lg_;
+            double lo = lg_ > o.lg_ ? o.lg_ : lg_;
+            if (lo == -std::numeric_limits<double>::infinity()) lg_ = hi;
+            else lg_ = hi + std::log1p(std::exp2(lo - hi)) * 1.44269504088896340736;  // 1 / ln 2
+            return *this;
+        }
+
+        LogRep& operator*=(const LogRep& o) {
+            lg_ += o.lg_;  // -inf 加有限值仍为 -inf
+            return *this;
+        }
+
+        friend bool operator==(const LogRep& a, const LogRep& b) { return a.lg_ == b.lg_; }
+
+        std::string toString() const {
+            if (isZero()) return "0";
+            if (lg_ < 53) return std::to_string(static_cast<uint64_t>(std::llround(std::exp2(lg_))));
+            double e = log10();
+            int exponent = static_cast<int>(std::floor(e));
+            double mantissa = std::pow(10.0, e - exponent);
+            if (mantissa >= 9.9999995) {
+                mantissa = 1.0;
+                exponent++;
+            }
+            char buf[48];
+            std::snprintf(buf, sizeof(buf), "%.6fe+%d", mantissa, exponent);
+            return buf;
+        }
+
+    private:
+        double lg_;
+};
+
+// 统一的计数类型：Count<Rep> 为不同的数值表示提供同一套接口，搜索、计数缓存与电路求值只依赖这套接口。
+// Rep 可取：
+//   BigCount      精确计数，64 位以内为内联整数，溢出后提升为大整数（16 字节）
+//   LogRep        对数域 double，近似计数（8 字节）
+//   ModCountK<K>  K 个 61 位素数下的余数，按中国剩余定理还原（8K 字节）
+// Rep 需要支持由 uint64_t 构造、+=、*=、==、isZero、toString 与 log10；表示特有的操作经 rep() 访问。
+template <typename Rep>
+class Count {
+    public:
+        using rep_type = Rep;
+
+        Count() : rep_(0) {}
+        Count(uint64_t v) : rep_(v) {}
+        explicit Count(const Rep& r) : rep_(r) {}
+
+        bool isZero() const { return rep_.isZero(); }
+        bool isFailure() const { return rep_.isZero(); }
+        std::string toString() const { return rep_.toString(); }
+        double log10() const { return rep_.log10(); }
+
+        const Rep& rep() const { return rep_; }
+        Rep& rep() { return rep_; }
+
+        Count& operator+=(const Count& o) {
+            rep_ += o.rep_;
+            return *this;
+        }
+        Count& operator*=(const Count& o) {
+            rep_ *= o.rep_;
+            return *this;
+        }
+
+        friend Count operator+(Count a, const Count& b) { return a += b; }
+        friend Count operator*(Count a, const Count& b) { return a *= b; }
+        friend bool operator==(const Count& a, const Count& b) { return a.rep_ == b.rep_; }
+        friend bool operator!=(const Count& a, const Count& b) { return !(a.rep_ == b.rep_); }
+
+    private:
+        Rep rep_;
+};
+
+using ExactCount = Count<BigCount>;
+using LogCount = Count<LogRep>;
+// 默认取 4 个素数，值为 32 字节，精确范围约为 2^243
+using ModCount = Count<ModCountK<4>>;
+
+#endif // COUNT_H
@@ -0,0 +1,168 @@
+#ifndef COUNT_CACHE_H
+#define COUNT_CACHE_H
+
+#include "Block.h"
+#include "common.h"
+#include "DnnfStore.h"
+
+#include <atomic>
+
+// 缓存查找模式
+enum class CacheMode {
+    Fingerprint,  // 只比较 64 位哈希，哈希碰撞时会返回错误的计数
+    Verified      // 命中时再比较规范化的列集合键，碰撞时视为未命中
+};
+
+CacheMode parseCacheMode(const std::string& name);
+std::string cacheModeName(CacheMode mode);
+
+// 解析内存大小，支持 K/M/G 后缀，不带后缀时单位为 MB
+size_t parseMemorySize(const std::string& text);
+
+// 子问题计数缓存：以块的 Zobrist 哈希为索引，条目保存计数与对应子电路的根节点，
+// Verified 模式下每个条目额外保存规范化键（升序列号的差分 varint 编码），键统一存放在字节池中。
+// 设置内存预算后按加权 CLOCK 策略淘汰，预算约束的是分片的实际占用（见 residentBytes）：条目的初始权重随子问题列数对数增长，命中时补充权重，
+// 时钟指针扫过时权重减一，降到 0 才被淘汰，因此大子问题的条目更不容易被淘汰。
+// 表按哈希高位分片，每个分片有独立的读写锁、索引、键池、时钟指针与统计计数，
+// 多线程（mdxd）下不同子问题的读写基本落在不同分片上，不再争用同一把锁。
+// Value 为搜索所用半环的值类型，成员定义在 CountCache.cpp 中，为 DNNFResult、ModCount、LogCount
+// 与 long double（加权和、最大积、最小和）显式实例化。
+template <typename Value>
+class BasicCountCache {
+    public:
+        static constexpr size_t DEFAULT_SHARDS = 64;
+
+        // shards 取不小于它的 2 的幂
+        explicit BasicCountCache(CacheMode mode = CacheMode::Verified, size_t shards = DEFAULT_SHARDS);
+        ~BasicCountCache();
+
+        BasicCountCache(const BasicCountCache&) = delete;
+        BasicCountCache& operator=(const BasicCountCache&) = delete;
+
+        void setMode(CacheMode mode) { mode_ = mode; }
+        CacheMode mode() const { return mode_; }
+
+        // 内存预算（字节），0 表示不限制；预算在分片间平均分配
+        void setBudget(size_t bytes);
+        size_t budget() const { return budget_; }
+
+        size_t shardCount() const { return shardCount_; }
+
+        // 查找块 cols 的计数与子电路，命中时写入 out 与 node
+        bool lookup(uint64_t hash, const SparseSet& cols, Value& out, dnnf_id& node);
+
+        // 写入块 cols 的计数与子电路，已存在相同键时覆盖
+        void insert(uint64_t hash, const SparseSet& cols, const Value& value, dnnf_id node);
+
+        void clear();
+
+        size_t entries() const;
+        size_t keyBytes() const;
+        uint64_t hits() const;
+        uint64_t misses() const;
+        uint64_t collisions() const;
+        uint64_t evictions() const;
+        // 各分片实际占用的字节数之和，设置预算时不超过预算
+        size_t memoryBytes() const;
+
+        // 统计信息，格式与 "DNNF Size" 等日志行一致
+        std::string summary() const;
+
+    private:
+        static constexpr uint32_t NIL = UINT32_MAX;
+
+        static constexpr uint8_t MAX_CREDIT = 15;
+        // unordered_map 节点与桶的大致开销
+        static constexpr size_t INDEX_OVERHEAD = 48;
+        // 写入时触发键池压缩的失效键字节数下限（另需失效键超过键池一半）。
+        // 分片前整张表只有一个键池，下限为 1MB；分片后每个分片各有一个键池，
+        // 仍用 1MB 时 64 个分片合计可积压 64MB 失效键，因此按分片数缩小到 64KB，总量与原来同一量级
+        static constexpr size_t COMPACT_MIN_DEAD_BYTES = size_t(1) << 16;
+
+        struct Entry {
+            uint64_t hash;
+            uint64_t keyOffset;  // 规范化键在分片 keyPool 中的起始位置
+            uint32_t keyLength;
+            uint32_t next;       // 同一哈希下的下一个条目（哈希碰撞链），空闲时为空闲链
+            dnnf_id node;        // 子电路根节点
+            uint8_t weight;      // 由子问题列数决定的权重
+            bool live;
+            std::atomic<uint8_t> credit;  // CLOCK 剩余机会，读锁下命中时更新
+            Value value;
+
+            Entry() : hash(0), keyOffset(0), keyLength(0), next(NIL), node(0), weight(0), live(false), credit(0) {}
+            Entry(const Entry& o)
+                : hash(o.hash), keyOffset(o.keyOffset), keyLength(o.keyLength), next(o.next), node(o.node),
+                  weight(o.weight), live(o.live), credit(o.credit.load(std::memory_order_relaxed)),
+                  value(o.value) {}
+            Entry& operator=(const Entry& o) {
+                hash = o.hash; keyOffset = o.keyOffset; keyLength = o.keyLength; next = o.next; node = o.node;
+                weight = o.weight; live = o.live;
+                credit.store(o.credit.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                value = o.value;
+                return *this;
+            }
+        };
+
+        // 按缓存行对齐，避免相邻分片的锁与计数器伪共享
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<uint64_t, uint32_t> index;  // 哈希 -> 碰撞链首条目
+            std::vector<Entry> entries;
+            std::vector<uint8_t> keyPool;
+            uint32_t freeHead = NIL;   // 空闲条目链
+            size_t liveEntries = 0;
+            size_t deadKeyBytes = 0;   // 被淘汰条目遗留在 keyPool 中的字节数
+            size_t clockHand = 0;
+            size_t budget = 0;
+
+            std::atomic<uint64_t> hits{0};
+            std::atomic<uint64_t> misses{0};
+            std::atomic<uint64_t> collisions{0};
+            std::atomic<uint64_t> evictions{0};
+        };
+
+        CacheMode mode_;
+        size_t budget_ = 0;
+        size_t shardCount_;
+        int shardShift_;
+        std::unique_ptr<Shard[]> shards_;
+
+        // Zobrist 哈希各位均匀，取高位选分片，低位留给分片内的 unordered_map
+        Shard& shardOf(uint64_t hash) const { return shards_[shardShift_ >= 64 ? 0 : hash >> shardShift_]; }
+
+        // 将列集合编码为规范化键，写入线程局部缓冲区
+        static const std::vector<uint8_t>& encode(const SparseSet& cols);
+
+        static uint8_t weightOf(size_t numCols);
+        static size_t entryBytes(uint32_t keyLength) { return sizeof(Entry) + keyLength + INDEX_OVERHEAD; }
+
+        // 分片的实际占用：条目数组与键池按容量计（含空闲槽位、待压缩的失效键与未用的预留空间），
+        // 索引按每个存活条目 INDEX_OVERHEAD 估计
+        static size_t residentBytes(const Shard& shard) {
+            return shard.entries.capacity() * sizeof(Entry) + shard.keyPool.capacity() +
+                   shard.liveEntries * INDEX_OVERHEAD;
+        }
+
+        static bool sameKey(const Shard& shard, const Entry& e, const std::vector<uint8_t>& key);
+        static void touch(const Shard& shard, Entry& e);
+
+        template <typename F>
+        uint64_t sumShards(F f) const;
+
+        // 以下均需持有分片写锁
+        // 保证有空闲槽位与 keyLength 字节的键池容量，且插入后实际占用不超过预算；放不下时返回 false
+        static bool makeRoom(Shard& shard, uint32_t keyLength);
+        static void evictNext(Shard& shard);
+        static void evict(Shard& shard, uint32_t id);
+        static void release(Shard& shard);
+        // 丢弃失效键，新键池的容量为存活键字节数加 extra
+        static void compactKeys(Shard& shard, size_t extra = 0);
+};
+
+using CountCache = BasicCountCache<DNNFResult>;
+using ModCountCache = BasicCountCache<ModCount>;
+using LogCountCache = BasicCountCache<LogCount>;
+using RealCountCache = BasicCountCache<long double>;
+
+#endif // COUNT_CACHE_H
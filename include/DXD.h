@@ -3,32 +3,29 @@
 
 #include "../include/DancingMatrix.h"
 #include "../include/DXDTime.h"
+#include "../include/CountCache.h"
+#include "../include/DnnfStore.h"
+#include "../include/Semiring.h"
 
 const int MIN_BLOCK_ROWS = 20;
 const int MAX_BLOCK_ROWS = 200;
 const int TIME_LIMIT_SECONDS = 1200; 
 const int TIME_LIMIT_BUILDING_SECONDS = 1200;
 const int MAX_DECOMPOSE_TIMES = 5;
-using namespace std;
-
-enum class NodeType { OR, Decision, Decomposed, Variable, Terminal };  // 节点类型 AND node 分为Decision和Decomposed两种
-
-struct DNNFNode {
-    NodeType type;
-    int label; // -1 for T, -2 for F
-    uint64_t count;
-    vector<std::shared_ptr<DNNFNode>> children; // 记录行id
-    std::shared_ptr<DNNFNode> left;
-    std::shared_ptr<DNNFNode> right;
-
-    DNNFNode() = default;
-    DNNFNode(NodeType t, int l) : type(t), label(l) {} // 构建变量节点和终端节点
-    DNNFNode(NodeType t, int l, uint64_t c) : type(t), label(l), count(c) {} // 构造函数用于OR节点和 Decomposed类型的AND节点   
-    DNNFNode(NodeType t, shared_ptr<DNNFNode> l, shared_ptr<DNNFNode> r) : type(t), left(l), right(r) {} // 构建Decision类型的AND节点
-    DNNFNode(int l, shared_ptr<DNNFNode> r, uint64_t c)  : type(NodeType::Decision), label(l), right(r), count(c) {} // 简化版决策节点
 
+// DXD 搜索中的计数方式
+enum class CountMode {
+    Exact,    // DNNFResult：64 位内联整数，溢出后提升为大整数
+    Modular   // ModCount：对多个 61 位素数取模，最后按中国剩余定理还原
 };
 
+inline CountMode parseCountMode(const std::string& name) {
+    if (name == "exact") return CountMode::Exact;
+    if (name == "mod") return CountMode::Modular;
+    throw std::invalid_argument("Unknown count mode: " + name);
+}
+using namespace std;
+
 class DanceDNNF : DancingMatrix { 
 
     public:
@@ -42,8 +39,9 @@ class DanceDNNF : DancingMatrix {
         }
 
         DanceDNNF(const string& file_path, int from, Logger& l, 
-                       const bool useIG = false, const bool useETT = false, int pool_size = 1, bool debug = false)
-            : DancingMatrix(file_path, from, useIG, useETT), 
+                       const bool useIG = false, const bool useETT = false, int pool_size = 1, bool debug = false,
+                       ConnectivityGraph conn = ConnectivityGraph::Clique)
+            : DancingMatrix(file_path, from, useIG, useETT, conn), 
             logger(l), 
             max_threads(pool_size), 
             debug(debug), 
@@ -74,17 +72,29 @@ class DanceDNNF : DancingMatrix {
         bool debug = false;
 
         // 构建Decision-ZDNNF
-        shared_ptr<DNNFNode> buildDecisionNode(int r, shared_ptr<DNNFNode> lo, shared_ptr<DNNFNode> hi);
+        dnnf_id buildDecisionNode(int r, dnnf_id lo, dnnf_id hi);
 
-        shared_ptr<DNNFNode> buildDecomposableNode(vector<shared_ptr<DNNFNode>>& subDNNFs);
+        dnnf_id buildDecomposableNode(vector<dnnf_id>& subDNNFs);
 
         // 多线程DLX
         DNNFResult parallelSearchMDLX(vector<Block>& blocks);
         DNNFResult MDLX(vector<int>& sols, Block& block);
 
-        DNNFResult DXD(Block& block, int depth);
-        DNNFResult serialSearch(vector<Block>& blocks, int depth);
-        DNNFResult parallelSearchUseOmp(vector<Block>& blocks, int depth);
+        // 返回块在半环 S 中的值（解数、加权和、最大积或最小和），node 为对应子电路的根节点（无解时为 FALSE_ID）。
+        // 选中行 r 的分支值为 w_r ⊗ 子块值，各分支以 ⊕ 合并，独立分块的值以 ⊗ 相乘；
+        // 计数半环不读取权重，实例化后与直接计数相同。每种值类型使用独立的计数缓存
+        template <typename S>
+        typename S::value_type DXD(Block& block, int depth, dnnf_id& node);
+        // 各分块的子电路组合为一个 AND 节点
+        template <typename S>
+        typename S::value_type serialSearch(vector<Block>& blocks, int depth, dnnf_id& node);
+        template <typename S>
+        typename S::value_type parallelSearchUseOmp(vector<Block>& blocks, int depth, dnnf_id& node);
+
+        // 从 InitBlock 开始搜索，返回解数的十进制文本。
+        // 指定了半环时在该半环中搜索，半环值记入 semiringValue，解数由电路线性求值得到；
+        // 否则按计数模式（精确或多模数）搜索
+        std::string searchRoot();
 
         // 启动搜索函数
         void startDXD();
@@ -103,28 +113,62 @@ class DanceDNNF : DancingMatrix {
 
         Block getBlock() {
             Block fullBlock(rowsSet, colsSet);
+            sealBlock(fullBlock);
             return fullBlock;
         };
 
-        std::shared_ptr<DNNFNode> getCache(const size_t& key){
-            std::shared_lock<std::shared_mutex> readLock(cacheMutex);
-            if(C.find(key) != C.end()){
-                return C[key];
-            }
-            return nullptr;
+        template <typename S>
+        void setCacheCount(const Block& block, const typename S::value_type& count, dnnf_id node){
+            cacheFor<S>().insert(block.stateHash, block.cols, count, node);
+        }
+
+        // 选择计数缓存的查找模式（默认 Verified）
+        void setCacheMode(CacheMode mode) {
+            countCache.setMode(mode); modCache.setMode(mode); logCache.setMode(mode); realCache.setMode(mode);
         }
+        // 计数缓存的内存预算（字节），0 表示不限制
+        void setCacheBudget(size_t bytes) {
+            countCache.setBudget(bytes); modCache.setBudget(bytes); logCache.setBudget(bytes); realCache.setBudget(bytes);
+        }
+        // 计数模式（默认精确计数）
+        void setCountMode(CountMode mode) { countMode = mode; }
+
+        // 搜索结束后导出电路的文件路径，空串表示不导出
+        void setExportPaths(const string& nnfPath, const string& binPath) {
+            exportNnfPath = nnfPath;
+            exportBinPath = binPath;
+        }
+        // 将以 rootDNNF 为根的电路写出到已设置的路径
+        void exportCircuit();
+
+        // 搜索结束后在电路上均匀抽取 count 个解，写到 path（空串表示标准输出）
+        void setSampling(size_t count, uint64_t seed, const string& path) {
+            sampleCount = count;
+            sampleSeed = seed;
+            samplePath = path;
+        }
+        void drawSamples();
 
-        void setCache(const size_t& key, std::shared_ptr<DNNFNode> node){
-            std::unique_lock<std::shared_mutex> writeLock(cacheMutex);
-            if(C.find(key) == C.end()){
-                C[key] = node;
-            }
+        // 搜索结束后逐个枚举解写到 path（"-" 表示标准输出），最多 limit 个
+        void setEnumeration(const string& path, uint64_t limit) {
+            enumeratePath = path;
+            enumerateLimit = limit;
         }
+        void enumerateSolutions();
 
-        void setCacheCount(const size_t& key, DNNFResult count){
-            std::unique_lock<std::shared_mutex> writeLock(cacheMutex);
-            countCache[key] = count;
+        // 在半环 name（count / mod / log / sum / maxprod / minsum）中搜索，行权重取自 weightsPath（空串表示全为单位元）
+        void setSemiring(const string& name, const string& weightsPath) {
+            semiringName = name;
+            searchWeights = weightsPath.empty() ? RowWeights(ROWS) : RowWeights::load(weightsPath, ROWS);
         }
+        // 输出半环值，选择性半环再给出取到该值的解
+        void evaluateSemiring();
+        const string& getSemiringValue() const { return semiringValue; }
+        // 上一次搜索结束时所用计数缓存的实际占用（字节）
+        size_t getCacheMemory() const { return cacheMemory; }
+
+        dnnf_id getRoot() const { return rootDNNF; }
+        const DnnfStore& getStore() const { return dnnf; }
 
         int getRecordCount(){
             std::shared_lock<std::shared_mutex> readLock(recordMutex);
@@ -143,10 +187,6 @@ class DanceDNNF : DancingMatrix {
             startDXD();
         }
 
-        inline size_t gen_key(int r, DNNFNode* x, DNNFNode* y) {
-            return std::hash<int>()(r) ^ (std::hash<int>()(x->label) << 1) ^ (std::hash<int>()(y->label) << 2);
-        }
-
     private:
         // ThreadPool& pool;
         Logger& logger;
@@ -157,22 +197,46 @@ class DanceDNNF : DancingMatrix {
         int num_of_DNNFNodes;
         int max_depth;
         vector<string> cache_input_order; // 记录缓存的输入顺序，便于输出
-        std::shared_ptr<DNNFNode> rootDNNF;
+        dnnf_id rootDNNF = DnnfStore::FALSE_ID;
+        string exportNnfPath, exportBinPath;
+        size_t sampleCount = 0;
+        uint64_t sampleSeed = 0;
+        string samplePath;
+        string enumeratePath;
+        uint64_t enumerateLimit = UINT64_MAX;
+        string semiringName;
+        RowWeights searchWeights;     // 加权半环搜索时的行权重
+        string semiringValue;         // 半环搜索的结果
+        string cacheSummary;          // 本次搜索所用计数缓存的统计
+        size_t cacheMemory = 0;       // 本次搜索所用计数缓存的实际占用
         std::unordered_set<size_t> records; // 用于记录无法分解的矩阵状态
-        std::shared_ptr<DNNFNode> T = std::make_shared<DNNFNode>(NodeType::Terminal, -1, 1);
-        std::shared_ptr<DNNFNode> F = std::make_shared<DNNFNode>(NodeType::Terminal, -2, 0);
         
-        // DNNF缓存
-        mutable std::shared_mutex cacheMutex;
         mutable std::shared_mutex recordMutex; // 记录互斥锁
-        unordered_map<size_t, shared_ptr<DNNFNode>> C;
 
-        // DNNF Nodes table
-        mutable std::shared_mutex tableMutex;
-        unordered_map<size_t, shared_ptr<DNNFNode>> node_table;
+        // DNNF 节点存储，tableMutex 保护并发构建
+        mutable std::mutex tableMutex;
+        DnnfStore dnnf;
+
+        // 轻量级缓存：只存半环值与子电路，每种值类型一个；一次搜索只用其中一个，
+        // 加权和、最大积与最小和的值同为 long double，共用 realCache
+        CountCache countCache;
+        ModCountCache modCache;
+        LogCountCache logCache;
+        RealCountCache realCache;
+        CountMode countMode = CountMode::Exact;
+
+        template <typename S>
+        auto& cacheFor() {
+            using V = typename S::value_type;
+            if constexpr (std::is_same_v<V, ModCount>) return modCache;
+            else if constexpr (std::is_same_v<V, LogCount>) return logCache;
+            else if constexpr (std::is_same_v<V, long double>) return realCache;
+            else return countCache;
+        }
 
-        // 轻量级缓存：只存计数
-        unordered_map<size_t, DNNFResult> countCache;
+        // 在半环 S 中从 InitBlock 搜索，记录所用缓存的统计
+        template <typename S>
+        typename S::value_type searchIn();
 
         ThreadPool& getThreadPool(int poolSize) {
             return ThreadPoolManager::get_instance(poolSize);
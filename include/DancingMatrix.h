@@ -5,6 +5,8 @@
 #include "ComponentDetector.h"
 // #include "BlockDetector.h"
 #include "common.h"
+#include "InstanceLoader.h"
+#include "DlxBuilder.h"
 
 using col_id = int;
 using row_id = int;
@@ -15,48 +17,29 @@ const int HEAP_THRESHOLD = 50;  // 列数超过50时使用堆排序
 const int MAX_TRIES = 10;
 const int MAX_CONCURRENT_THREADS = 16;
 
-struct Node  
-{  
-    Node* left, *right, *up, *down;  
-    int col, row;  
-    bool row_first_node;
-    Node(int r = -1, int c = -1) 
-        : row(r), col(c), left(nullptr), right(nullptr), 
-          up(nullptr), down(nullptr), row_first_node(false) {} 
-    
-    virtual ~Node() = default;
-};  
-
-struct ColumnHeader : public Node  
-{  
-    int size;
-    set<int> rows;
-    ColumnHeader() : size(0) {
-    }  
-}; 
-
-struct RowNode : public Node
-{
-    int size;
-    set<int> cols;
-    RowNode() :  size(0) {}
-
-};
-
 // 列信息结构体，用于堆排序
 struct ColumnInfo {
     int colId;
     int size;
-    ColumnHeader* header;
     
-    // 小根堆比较器：size小的优先
+    // 小根堆比较器：size小的优先，size相同时列号小的优先
     bool operator>(const ColumnInfo& other) const {
-        return size > other.size;
+        return size != other.size ? size > other.size : colId > other.colId;
     }
 };
 
 class IncrementalConnectedGraph;
 
+// ETT 维护连通性所用的图
+// Clique：行冲突图，同一列的行两两相连，边数为 Σ|列|^2；
+// Bipartite：行-列关联图，行 r 为顶点 r，列 c 为顶点 ROWS + c - 1，边数等于非零元数。
+// 两者的行连通分量相同：列被覆盖时其中的行都已删除，列顶点在失去全部活跃行时随之删除，
+// 因此每棵树都含有行，getComponentsByETT 得到的块与 Clique 一致。
+enum class ConnectivityGraph { Clique, Bipartite };
+
+ConnectivityGraph parseConnectivityGraph(const std::string& name);
+std::string connectivityGraphName(ConnectivityGraph graph);
+
 class DancingMatrix 
 {  
     public:  
@@ -70,7 +53,6 @@ class DancingMatrix
         double countTimeSeconds = 0.0;
         bool useETT;
         bool useIG; // 使用增量图
-        std::vector<std::vector<int>> solutions; 
         set<int> rowsSet;  // 舞蹈链行id
         set<int> colsSet;  // 原始矩阵列
         unordered_set<int> active_rows;
@@ -86,7 +68,10 @@ class DancingMatrix
         
         //接收矩阵其及维度  
         DancingMatrix( int rows, int cols, int** matrix, bool verbose = false);  
-        DancingMatrix( const string& file_path, int from, bool use_ig = false, bool use_ett = false);
+        DancingMatrix( const string& file_path, int from, bool use_ig = false, bool use_ett = false,
+                       ConnectivityGraph conn = ConnectivityGraph::Clique);
+
+        ConnectivityGraph connectivity = ConnectivityGraph::Clique;
 
         // 检测器，用于检测矩阵中的连通性
         std::unique_ptr<ComponentDetector> detector;
@@ -122,50 +107,45 @@ class DancingMatrix
         void uncoverInBlock(int c, Block& block);
 
         string encodeBlockState(const unordered_set<int>& cols);
-        size_t hashBlockState(const set<int>& cols);
+        size_t hashBlockState(const SparseSet& cols);
+        // 为新建的块计算一次哈希，之后由 coverInBlock/uncoverInBlock 增量维护
+        void sealBlock(Block& block) { block.stateHash = hashBlockState(block.cols); }
      
-        ColumnHeader* selectCol();
-        ColumnHeader* selectColumnHeuristic(const set<int>& cols);
-        ColumnHeader* selectColumnByLinear(const set<int>& cols, int threshold);
-        ColumnHeader* selectColumnByMinHeap(const set<int>& cols, int threshold);
-        ColumnHeader* selectOptimalColumn(const set<int>& cols);
+        col_id selectCol();
+        col_id selectColumnHeuristic(const SparseSet& cols);
+        col_id selectColumnByLinear(const SparseSet& cols, int threshold);
+        col_id selectColumnByMinHeap(const SparseSet& cols, int threshold);
+        col_id selectOptimalColumn(Block& block);
         col_id getClosedSizeCol(const int expected_size);
         col_id getSmallestSizeCol();
-        // ColumnHeader* fastSelect();
 
-        inline ColumnHeader* getColumnHeader(int c) const {
-            // std::shared_lock lock(mutex_);
-            ColumnHeader* col = &ColIndex[c];
-            return col;
-        }
+        // 舞蹈链节点存储，列头下标即列号，ROOT 为根节点
+        static constexpr DlxArena::index_t ROOT = 0;
+        DlxArena dlx;
 
         inline int getColSize(int c) const {
-            // std::shared_lock lock(mutex_);
-            return ColIndex[c].size;
+            return colSize[c];
         }
 
         inline void decColSize(int c) {
-            // std::unique_lock lock(mutex_);
-            ColIndex[c].size--;
+            colSize[c]--;
         }
 
         inline void incColSize(int c) {
-            // std::unique_lock lock(mutex_);
-            ColIndex[c].size++;
+            colSize[c]++;
         }
 
-        inline RowNode* getRowHeader(int r) const {
-            std::shared_lock lock(mutex_);
-            RowNode* row = &RowIndex[r];
-            return row;
+        // 行的首个数据节点，0 表示该行为空
+        inline DlxArena::index_t getRowHead(int r) const {
+            return rowHead[r];
         }
 
         inline bool isSolved() const {
-            return root->right == root;
+            return dlx.R(ROOT) == ROOT;
         }
 
         // IBD: Independent Block Detection
-        vector<Block> getComponentsByIG(const set<int> rows);
+        vector<Block> getComponentsByIG(const SparseSet& rows);
         vector<Block> getComponentsByETT();
 
         void turnOnGraphSync() {
@@ -221,10 +201,13 @@ class DancingMatrix
         void testDynamicUpdateCC(const std::vector<int>& deletedVertices);
 
     private:  
-        ColumnHeader* root;  
-        std::unique_ptr<ColumnHeader[]> ColIndex;
-        std::unique_ptr<RowNode[]> RowIndex;
-        std::vector<std::unique_ptr<Node>> dataNodes;
+        std::unique_ptr<int[]> colSize;                 // 列中当前激活的节点数
+        std::unique_ptr<int[]> rowSize;                 // 行中的节点数
+        std::unique_ptr<DlxArena::index_t[]> rowHead;   // 行的首个数据节点
+        std::unique_ptr<uint64_t[]> colKey;             // 每列的 Zobrist 随机键
+
+        // 初始化根节点与列头，并为 nnz 个数据节点预留空间
+        void initHeaders(int rows, int cols, size_t nnz);
 
         std::unique_ptr<IncrementalConnectedGraph> incrementalGraph;
 
@@ -238,10 +221,21 @@ class DancingMatrix
 
         mutable std::shared_mutex graph_sync_mutex; // 图同步锁
 
+        // 由 CSR 数据建立舞蹈链、row_to_cols 与 col_to_rows
+        void buildFromCsr(const CsrView& csr);
+
         // Graph build_graph_from_columns(const unordered_map<int, vector<int>>& col2rows, int num_rows, bool deduplicate = true);
 
         bool enableGraphSync = true; // 是否启用图同步   
         
+        // Bipartite 模式下每列的活跃行数，降为 0 时删除列顶点，由 0 恢复时恢复列顶点。
+        // mdxd 各线程处理的块列集合互不相交，共享同一数组不会写同一元素
+        std::vector<int> colLiveRows;
+
+        int columnVertex(int c) const { return ROWS + c - 1; }
+        // 把行集合 rows 与随之删除（restoring 为 false）或恢复的列顶点按升序写入 out，并更新 colLiveRows
+        void withColumnVertices(const std::set<int>& rows, bool restoring, std::vector<int>& out);
+
         // 深拷贝单个树
         std::unique_ptr<splaytree::EulerTourTree> deepCopyTree(
             splaytree::EulerTourTree* original);
@@ -252,9 +246,14 @@ class DancingMatrix
     public:
         // build undirected graph from matrix
         std::unique_ptr<Graph> graph;
+        // 顶点 -> 所在欧拉回路树（主线程），由 EulerTourTree 在 link / cut / 增删顶点时维护；
+        // 需先于 components 声明，析构时树才能从仍存在的表中注销
+        std::vector<splaytree::EulerTourTree*> vertexTrees;
         // 连通分量管理
         std::vector<std::unique_ptr<splaytree::EulerTourTree>> components;
+        // 按路由表 O(1) 定位顶点所在的树；routeByIndex 为 false 时退回逐棵树线性查找（仅用于基准对比）
         splaytree::EulerTourTree* findEulerTourTree(int v);
+        bool routeByIndex = true;
         int nextTreeId = 0;
 
         // === 线程局部数据结构 ===
@@ -276,6 +275,8 @@ class DancingMatrix
         
         // thread_local 存储
         static thread_local std::unique_ptr<ThreadLocalState> tlsState;
+        // 线程局部的顶点 -> 树路由表。跨任务保留容量，任务结束时树析构把表项清空
+        static thread_local std::vector<splaytree::EulerTourTree*> tlsVertexTrees;
 
         // 初始化线程局部状态
         void initThreadLocalState(const Block& block, 
@@ -294,6 +295,11 @@ class DancingMatrix
             return isThreadLocal() ? tlsState->components : components;
         }
 
+        // 获取当前线程的顶点 -> 树路由表
+        std::vector<splaytree::EulerTourTree*>& getVertexTrees() {
+            return isThreadLocal() ? tlsVertexTrees : vertexTrees;
+        }
+
         // 获取当前线程的 graph
         // Graph* getGraph() {
         //     if (isThreadLocal()) {
@@ -330,6 +336,8 @@ class DancingMatrix
         void buildSpanningForest();
         std::vector<splaytree::Edge> bfsSpanningTree(int start, std::unordered_set<int>& visited, std::unordered_set<int>& componentVertices);
         void processBoundaryVertex(int v, splaytree::EulerTourTree* tree, SubGraph* g);
+        // 从 components 中去掉已清空的树（其余树保持原顺序），空树交给 EulerTourTree::recycle
+        void recycleEmptyTrees();
 };
 
 #endif
\ No newline at end of file
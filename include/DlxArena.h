@@ -0,0 +1,77 @@
+#ifndef DLX_ARENA_H
+#define DLX_ARENA_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// 基于数组下标的舞蹈链节点存储（Knuth DLX 风格）
+// 下标 0 为根节点，1..cols 为列头（下标即列号），之后为数据节点。
+// 链接全部是 32 位下标，按访问模式分成三组并放在同一块连续内存中：
+//   vlink = {up, down}    —— cover/uncover 解链时一起读写
+//   hlink = {left, right} —— 沿行遍历时使用
+//   owner = {col, row}    —— 节点所属的列与行
+struct DlxArena {
+    using index_t = uint32_t;
+
+    struct VLink { index_t up, down; };
+    struct HLink { index_t left, right; };
+    struct Owner { int32_t col, row; };
+
+    VLink* vlink = nullptr;
+    HLink* hlink = nullptr;
+    Owner* owner = nullptr;
+
+    DlxArena() = default;
+    DlxArena(const DlxArena&) = delete;
+    DlxArena& operator=(const DlxArena&) = delete;
+
+    // 预留 n 个节点的空间；扩容时整体搬迁，已分配的下标保持有效
+    void reserve(size_t n) {
+        if (n <= capacity_) return;
+        size_t bytes = n * (sizeof(VLink) + sizeof(HLink) + sizeof(Owner));
+        std::unique_ptr<unsigned char[]> fresh(new unsigned char[bytes]);
+
+        VLink* v = reinterpret_cast<VLink*>(fresh.get());
+        HLink* h = reinterpret_cast<HLink*>(v + n);
+        Owner* o = reinterpret_cast<Owner*>(h + n);
+        if (size_) {
+            std::memcpy(v, vlink, size_ * sizeof(VLink));
+            std::memcpy(h, hlink, size_ * sizeof(HLink));
+            std::memcpy(o, owner, size_ * sizeof(Owner));
+        }
+
+        block_ = std::move(fresh);
+        vlink = v;
+        hlink = h;
+        owner = o;
+        capacity_ = n;
+    }
+
+    // 分配一个自环节点
+    index_t allocate(int32_t col, int32_t row) {
+        if (size_ == capacity_) reserve(capacity_ ? capacity_ * 2 : 64);
+        index_t x = static_cast<index_t>(size_++);
+        vlink[x] = {x, x};
+        hlink[x] = {x, x};
+        owner[x] = {col, row};
+        return x;
+    }
+
+    size_t size() const { return size_; }
+    size_t bytes() const { return capacity_ * (sizeof(VLink) + sizeof(HLink) + sizeof(Owner)); }
+
+    inline index_t U(index_t x) const { return vlink[x].up; }
+    inline index_t D(index_t x) const { return vlink[x].down; }
+    inline index_t L(index_t x) const { return hlink[x].left; }
+    inline index_t R(index_t x) const { return hlink[x].right; }
+    inline int32_t C(index_t x) const { return owner[x].col; }
+    inline int32_t ROW(index_t x) const { return owner[x].row; }
+
+private:
+    std::unique_ptr<unsigned char[]> block_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+};
+
+#endif // DLX_ARENA_H
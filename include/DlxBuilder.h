@@ -0,0 +1,28 @@
+#ifndef DLX_BUILDER_H
+#define DLX_BUILDER_H
+
+#include "DlxArena.h"
+#include "InstanceLoader.h"
+
+// 舞蹈链的建立：逐个有序插入与 CSR 批量建立两种方式，二者得到完全相同的链接结构
+// （节点下标按行优先分配，列内按行号升序，行内按列号升序，行首为该行第一个读入的节点）
+namespace DlxBuilder {
+
+    using index_t = DlxArena::index_t;
+
+    // 分配根节点与列头（下标 0..cols），并为 nnz 个数据节点预留空间
+    void initHeaders(DlxArena& dlx, int cols, size_t nnz);
+
+    // 有序插入单个节点：沿列链与行链线性查找插入位置，单个节点代价与列长、行长成正比
+    void insertSorted(DlxArena& dlx, int* colSize, int* rowSize, index_t* rowHead, int r, int c);
+
+    // 批量建立：先统计列大小，再按行顺序一次性把每个节点接到列尾，并对每行整体成环，
+    // 总代价 O(rows + cols + nnz)。要求每行列号严格升序（InstanceLoader 保证），colSize、rowSize、rowHead 需预先清零
+    void linkBulk(DlxArena& dlx, const CsrView& csr, int* colSize, int* rowSize, index_t* rowHead);
+
+    // 两个舞蹈链的节点数与全部链接是否一致
+    bool sameStructure(const DlxArena& a, const DlxArena& b);
+
+}
+
+#endif // DLX_BUILDER_H
@@ -0,0 +1,64 @@
+#ifndef DNNF_ENUMERATOR_H
+#define DNNF_ENUMERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "DnnfStore.h"
+
+// 在编译后的电路上逐个枚举全部解，内存只与当前解的大小成正比。
+// 状态是当前解的推导树，按先序存放在 frames_ 中：决策帧记录链上当前选中的行，AND 帧记录分解节点。
+// 取下一个解时从后往前找第一个还能沿链后移的决策帧，像里程表一样进位：
+// 该帧换到链上的下一行，之后的帧（它的子树以及各祖先 AND 节点中位于其后的分块）全部截掉，
+// 再从各自的第一个解重新展开。因此独立分块的解按笛卡尔积展开，最后一个分块变化最快。
+class DnnfEnumerator {
+    public:
+        DnnfEnumerator(const DnnfStore& store, dnnf_id root);
+
+        // 取下一个解，rows 为选中的行（从 0 开始，按推导树先序）；没有更多解时返回 false
+        bool next(std::vector<int>& rows);
+
+        // 依次对每个解调用 f(rows)，最多 limit 个，返回枚举的解数
+        template <typename F>
+        uint64_t forEach(F&& f, uint64_t limit = UINT64_MAX) {
+            std::vector<int> rows;
+            uint64_t n = 0;
+            while (n < limit && next(rows)) {
+                f(rows);
+                n++;
+            }
+            return n;
+        }
+
+        // 将解逐行写入 out，行号从 1 开始，最多 limit 个，返回写出的解数
+        uint64_t writeTo(std::ostream& out, uint64_t limit = UINT64_MAX);
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Frame {
+            dnnf_id node;     // 决策帧为链上当前选中的节点，AND 帧为分解节点
+            uint32_t parent;  // 父帧下标
+            uint32_t slot;    // 在父 AND 帧中的子节点序号
+        };
+
+        struct Pending {
+            dnnf_id node;
+            uint32_t parent;
+            uint32_t slot;
+        };
+
+        const DnnfStore& store_;
+        dnnf_id root_;
+        bool started_ = false;
+        bool done_ = false;
+        std::vector<Frame> frames_;
+        std::vector<Pending> work_;
+        std::vector<Pending> tail_;
+
+        // 按先序展开 work_ 中的子电路，每个子电路取第一个解
+        void expand();
+};
+
+#endif // DNNF_ENUMERATOR_H
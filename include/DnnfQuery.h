@@ -0,0 +1,42 @@
+#ifndef DNNF_QUERY_H
+#define DNNF_QUERY_H
+
+#include <climits>
+#include <vector>
+
+#include "common.h"
+#include "DnnfStore.h"
+
+// 编译后电路上的查询：电路节点按编号升序即为拓扑序，每个查询都是一次线性扫描，无需重新搜索。
+// 行号从 0 开始，与节点记录中的 label 一致。
+class DnnfQuery {
+    public:
+        DnnfQuery(const DnnfStore& store, dnnf_id root, int numVars);
+
+        int numVars() const { return numVars_; }
+        size_t reachableNodes() const { return order_.size(); }
+
+        // 解的总数
+        DNNFResult count() const;
+
+        // 必须选 forced 中的行、不能选 forbidden 中的行时的解数。
+        // 每个解中一行至多被选一次，因此按"已满足的 forced 行数"维护长度 k+1 的截断多项式，
+        // 决策节点上 forced 行的 hi 分支次数加一，AND 节点做截断卷积，取 k 次项系数，代价为 O(|电路| * k^2)。
+        DNNFResult conditionedCount(const std::vector<int>& forced, const std::vector<int>& forbidden) const;
+
+        // marginals[r] 为包含行 r 的解数，一次前向求值加一次反向传播得到全部行。
+        // 反向传播时 AND 节点的第 i 个子节点得到 父节点梯度 * 其余子节点值之积，用前缀积/后缀积计算，不做除法；
+        // 决定性保证每个解中的行 r 恰由一个 label 为 r 的决策节点的 hi 分支选出。
+        std::vector<DNNFResult> marginals() const;
+
+        // 自底向上求每个节点的解数，按节点编号下标
+        std::vector<DNNFResult> nodeCounts() const;
+
+    private:
+        const DnnfStore& store_;
+        dnnf_id root_;
+        int numVars_;
+        std::vector<dnnf_id> order_;  // 从根可达的节点，升序
+};
+
+#endif // DNNF_QUERY_H
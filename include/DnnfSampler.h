@@ -0,0 +1,34 @@
+#ifndef DNNF_SAMPLER_H
+#define DNNF_SAMPLER_H
+
+#include <climits>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "common.h"
+#include "DnnfStore.h"
+
+// 在编译后的电路上均匀抽取解：构造时自底向上求出每个节点的解数，
+// 抽样时自根向下，决策链上按各行 hi 子电路的解数成比例地选行，AND 节点的各分块独立抽样。
+// 每条决策链只抽一个 [0, 链的解数) 内的整数并沿链扣减，分布精确均匀；链的解数不超过 64 位时不涉及大整数运算。
+// sample 不修改成员，多个线程可各用自己的随机数发生器并发抽样。
+class DnnfSampler {
+    public:
+        DnnfSampler(const DnnfStore& store, dnnf_id root, int numVars);
+
+        const DNNFResult& total() const { return counts_[root_]; }
+
+        // 抽取一个解，rows 为选中的行（从 0 开始，升序）；无解时返回 false
+        bool sample(std::mt19937_64& rng, std::vector<int>& rows) const;
+
+        // 抽取 n 个解写入 out，每行一个解，行号从 1 开始；返回实际写出的解数
+        size_t sampleTo(std::ostream& out, size_t n, std::mt19937_64& rng) const;
+
+    private:
+        const DnnfStore& store_;
+        dnnf_id root_;
+        std::vector<DNNFResult> counts_;  // 每个节点的解数，按节点编号下标
+};
+
+#endif // DNNF_SAMPLER_H
@@ -0,0 +1,124 @@
+#ifndef DNNF_STORE_H
+#define DNNF_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using dnnf_id = uint32_t;
+
+enum class DnnfKind : uint8_t { False, True, Decision, And };
+
+// 定长 16 字节节点记录
+//   Decision: label 为行号，a = lo（不选该行），b = hi（选该行）
+//   And:      label = -3，a 为子节点区间在 children 中的起点，b 为子节点个数
+struct DnnfNodeRecord {
+    DnnfKind kind;
+    uint8_t pad[3];
+    int32_t label;
+    uint32_t a;
+    uint32_t b;
+};
+static_assert(sizeof(DnnfNodeRecord) == 16, "DnnfNodeRecord must stay 16 bytes");
+
+// 二进制 d-DNNF 文件头
+struct BinaryDnnfHeader {
+    static constexpr char MAGIC[8] = {'D', 'X', 'D', 'N', 'N', 'F', '0', '1'};
+
+    char magic[8];
+    uint32_t version;
+    uint32_t numVars;
+    uint32_t nodeCount;
+    uint32_t childCount;
+    uint32_t root;
+    uint32_t reserved;
+};
+static_assert(sizeof(BinaryDnnfHeader) == 32, "BinaryDnnfHeader must stay 32 bytes");
+
+// d-DNNF 节点存储：节点记录与 AND 子节点区间分别放在连续数组中，以 32 位编号引用，
+// 决策节点经唯一表按 (row, lo, hi) 精确去重。唯一表为线性探测的开放寻址表，
+// 槽位只存节点编号，键从节点记录中读取；负载超过 MAX_LOAD 时容量翻倍并重新插入。
+// 本类不加锁，并发构建时由调用方加锁。
+class DnnfStore {
+    public:
+        static constexpr dnnf_id FALSE_ID = 0;
+        static constexpr dnnf_id TRUE_ID = 1;
+
+        DnnfStore();
+
+        DnnfStore(const DnnfStore&) = delete;
+        DnnfStore& operator=(const DnnfStore&) = delete;
+
+        // 返回 (row, lo, hi) 对应的决策节点，不存在时新建；created 表示是否新建
+        dnnf_id makeDecision(int row, dnnf_id lo, dnnf_id hi, bool* created = nullptr);
+
+        // 新建以 children[0, n) 为子节点的 AND 节点
+        dnnf_id makeAnd(const dnnf_id* children, size_t n);
+
+        const DnnfNodeRecord& node(dnnf_id id) const { return nodes_[id]; }
+        const dnnf_id* childBegin(const DnnfNodeRecord& n) const { return children_.data() + n.a; }
+        const dnnf_id* childEnd(const DnnfNodeRecord& n) const { return children_.data() + n.a + n.b; }
+
+        size_t size() const { return nodes_.size(); }
+        size_t decisionCount() const { return decisionCount_; }
+        size_t andCount() const { return andCount_; }
+        size_t childCount() const { return children_.size(); }
+
+        void clear();
+
+        // 唯一表状态
+        size_t tableCapacity() const { return slots_.size(); }
+        double loadFactor() const { return slots_.empty() ? 0.0 : double(decisionCount_) / slots_.size(); }
+        double averageProbes() const { return lookups_ ? double(probes_) / lookups_ : 0.0; }
+
+        // 节点数组、子节点数组与唯一表占用的字节数
+        size_t bytes() const;
+        double bytesPerNode() const { return nodes_.empty() ? 0.0 : double(bytes()) / nodes_.size(); }
+
+        // 统计信息，格式与 "DNNF Size" 等日志行一致
+        std::string summary() const;
+
+        // 从 root 可达的节点编号，升序即拓扑序（子节点总是先于父节点创建）
+        std::vector<dnnf_id> reachable(dnnf_id root) const;
+
+        // 导出为 c2d 的 .nnf 格式（平滑的 d-DNNF），变量 i 对应行 i-1。
+        // 电路为零抑制语义：路径上未出现的行取假（与 ZDD 相同）。导出时每个分支合取本节点出现、
+        // 该分支未出现的行的负文字，决策节点写成 O r 2 (A r hi -x...) (A -r lo -y...)，
+        // 根节点再合取电路中未出现的行的负文字，使标准 d-DNNF 语义下的模型恰为全部精确覆盖。
+        // AND 节点的子电路行集合互不相交。
+        void writeNnf(const std::string& path, dnnf_id root, int numVars) const;
+
+        // 导出/载入二进制格式：BinaryDnnfHeader 后依次为节点记录与子节点编号，只包含可达节点
+        void writeBinary(const std::string& path, dnnf_id root, int numVars) const;
+        // 清空当前内容并载入文件，返回根节点编号；0、1 号不是终端节点、子节点引用不指向更早的节点
+        // 或决策行号不小于 numVars 时抛出异常，存储恢复为只有终端节点
+        dnnf_id readBinary(const std::string& path, int& numVars);
+
+    private:
+        static constexpr dnnf_id EMPTY = UINT32_MAX;
+        static constexpr double MAX_LOAD = 0.5;
+
+        std::vector<DnnfNodeRecord> nodes_;
+        std::vector<dnnf_id> children_;
+        std::vector<dnnf_id> slots_;   // 唯一表，容量为 2 的幂
+        size_t decisionCount_ = 0;
+        size_t andCount_ = 0;
+        uint64_t lookups_ = 0;         // 唯一表查找次数
+        uint64_t probes_ = 0;          // 累计探测的槽位数
+        size_t maxProbe_ = 0;
+        size_t resizes_ = 0;
+
+        static size_t hashKey(int32_t row, dnnf_id lo, dnnf_id hi) {
+            uint64_t h = uint64_t(uint32_t(row)) * 0x9E3779B97F4A7C15ULL
+                       + (uint64_t(lo) << 32 | hi) * 0xD6E8FEB86659FD93ULL;
+            h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+
+        void rehash(size_t capacity);
+        dnnf_id push(DnnfKind kind, int32_t label, uint32_t a, uint32_t b);
+};
+
+#endif // DNNF_STORE_H
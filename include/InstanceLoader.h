@@ -0,0 +1,99 @@
+#ifndef INSTANCE_LOADER_H
+#define INSTANCE_LOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 只读内存映射文件（RAII），析构时自动 munmap
+class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        int fd_ = -1;
+};
+
+// CSR 只读视图，可指向 SparseInstance 的内存或直接指向映射的二进制文件
+struct CsrView {
+    int rows = 0;
+    int cols = 0;
+    size_t nnz = 0;
+    const uint32_t* rowOffsets = nullptr;  // 长度 rows + 1
+    const int32_t* colIndices = nullptr;   // 长度 nnz，列号从1开始
+    // 可选的列 -> 行索引，colOffsets 按列号下标，长度 cols + 2
+    const uint32_t* colOffsets = nullptr;
+    const int32_t* colRows = nullptr;
+
+    bool hasColumnIndex() const { return colOffsets && colRows; }
+};
+
+// 按行压缩存储（CSR）的精确覆盖实例，列号从1开始
+struct SparseInstance {
+    int rows = 0;
+    int cols = 0;
+    std::vector<uint32_t> rowOffsets;  // 长度 rows + 1
+    std::vector<int32_t> colIndices;   // 长度 nnz
+
+    size_t nnz() const { return colIndices.size(); }
+
+    CsrView view() const {
+        CsrView v;
+        v.rows = rows;
+        v.cols = cols;
+        v.nnz = colIndices.size();
+        v.rowOffsets = rowOffsets.data();
+        v.colIndices = colIndices.data();
+        return v;
+    }
+};
+
+// 二进制实例文件头，其后依次为 rowOffsets[rows+1]、colIndices[nnz]，
+// 若 flags 含 HAS_COLUMN_INDEX 再跟 colOffsets[cols+2]、colRows[nnz]
+struct BinaryInstanceHeader {
+    static constexpr char MAGIC[8] = {'D', 'X', 'D', 'C', 'S', 'R', '0', '1'};
+    static constexpr uint32_t HAS_COLUMN_INDEX = 1u;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    int32_t rows;
+    int32_t cols;
+    uint64_t nnz;
+};
+static_assert(sizeof(BinaryInstanceHeader) == 32, "BinaryInstanceHeader must stay 32 bytes");
+
+class InstanceLoader {
+    public:
+        // 解析文本实例，from 与 DancingMatrix 的读取模式一致：
+        // 1 -> exact_cover_benchmark (.ec)，2 -> set_partitioning，3 -> run_set
+        static SparseInstance parseText(const std::string& file_path, int from);
+
+        // 解析已映射的缓冲区，不产生中间字符串
+        static SparseInstance parseBuffer(const char* begin, const char* end, int from);
+
+        // 缓冲区是否为二进制 CSR 实例
+        static bool isBinary(const char* data, size_t size);
+
+        // 在映射的二进制缓冲区上建立零拷贝视图（缓冲区需在视图使用期间保持有效）
+        static CsrView viewBinary(const char* data, size_t size);
+
+        // 检查偏移单调且以 nnz 结束、列号与行号在范围内、列索引是 CSR 的转置，不合法时抛出与文本解析相同的异常
+        static void validate(const CsrView& v);
+
+        // 写出二进制 CSR 实例，withColumnIndex 时附带列 -> 行索引
+        static void writeBinary(const SparseInstance& inst, const std::string& out_path,
+                                bool withColumnIndex = true);
+};
+
+#endif // INSTANCE_LOADER_H
@@ -0,0 +1,117 @@
+#ifndef MOD_COUNT_H
+#define MOD_COUNT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "BigCount.h"
+
+// 多模数计数：同时对 K 个形如 2^61 - c 的素数取模，每个值是定长数组，加法与乘法不分配内存、不分支到大整数。
+// 乘积先折叠高位（2^61 ≡ c），再做一次条件减法，不需要 128 位除法。
+// 结束时用 Garner 算法按中国剩余定理还原，真实计数小于 K 个素数之积（约 2^(61K)）时结果精确。
+template <size_t K>
+class ModCountK {
+    public:
+        static_assert(K >= 1 && K <= 8, "ModCountK supports 1 to 8 moduli");
+
+        static constexpr uint64_t MASK = (uint64_t(1) << 61) - 1;
+        // 2^61 - c 形式的素数，c 依次为 1, 31, 45, 229, 259, 283, 339, 391
+        static constexpr uint64_t OFFSETS[8] = {1, 31, 45, 229, 259, 283, 339, 391};
+        static constexpr uint64_t prime(size_t i) { return MASK + 1 - OFFSETS[i]; }
+        // 精确还原的上界为 2^BOUND_BITS
+        static constexpr int BOUND_BITS = static_cast<int>(61 * K) - 1;
+        static constexpr size_t size() { return K; }
+
+        ModCountK() { r_.fill(0); }
+        ModCountK(uint64_t v) {
+            for (size_t i = 0; i < K; i++) r_[i] = v % prime(i);
+        }
+
+        // 全部余数为 0；真实计数为 0 或为全部素数之积的倍数
+        bool isZero() const {
+            for (uint64_t x : r_) if (x) return false;
+            return true;
+        }
+        bool isFailure() const { return isZero(); }
+
+        uint64_t residue(size_t i) const { return r_[i]; }
+
+        ModCountK& operator+=(const ModCountK& o) {
+            for (size_t i = 0; i < K; i++) {
+                uint64_t s = r_[i] + o.r_[i];  // 两数均小于 2^61，不会溢出
+                r_[i] = s >= prime(i) ? s - prime(i) : s;
+            }
+            return *this;
+        }
+
+        ModCountK& operator*=(const ModCountK& o) {
+            for (size_t i = 0; i < K; i++) r_[i] = mulMod(r_[i], o.r_[i], i);
+            return *this;
+        }
+
+        friend ModCountK operator+(ModCountK a, const ModCountK& b) { return a += b; }
+        friend ModCountK operator*(ModCountK a, const ModCountK& b) { return a *= b; }
+        friend bool operator==(const ModCountK& a, const ModCountK& b) { return a.r_ == b.r_; }
+
+        // 按中国剩余定理还原为 [0, 素数之积) 内的整数
+        BigCount reconstruct() const {
+            const auto& inv = inverses();
+            // Garner：x = v0 + v1 p0 + v2 p0 p1 + ...，v_i 在模 p_i 下逐个求出
+            std::array<uint64_t, K> v;
+            for (size_t i = 0; i < K; i++) {
+                uint64_t x = r_[i];
+                for (size_t j = 0; j < i; j++) {
+                    uint64_t vj = v[j] % prime(i);
+                    x = (x >= vj) ? x - vj : x + prime(i) - vj;
+                    x = mulMod(x, inv[j][i], i);
+                }
+                v[i] = x;
+            }
+            BigCount result(v[K - 1]);
+            for (size_t i = K - 1; i-- > 0;) {
+                result *= BigCount(prime(i));
+                result += BigCount(v[i]);
+            }
+            return result;
+        }
+
+        std::string toString() const { return reconstruct().toString(); }
+        double log10() const { return reconstruct().log10(); }
+
+    private:
+        std::array<uint64_t, K> r_;
+
+        static uint64_t mulMod(uint64_t a, uint64_t b, size_t i) {
+            unsigned __int128 x = (unsigned __int128)a * b;
+            const uint64_t c = OFFSETS[i];
+            // x < 2^122：两次折叠后小于 2 * p，再做一次条件减法
+            x = (x & MASK) + (x >> 61) * c;
+            uint64_t y = static_cast<uint64_t>((x & MASK) + (x >> 61) * c);
+            return y >= prime(i) ? y - prime(i) : y;
+        }
+
+        static uint64_t powMod(uint64_t a, uint64_t e, size_t i) {
+            uint64_t r = 1;
+            for (; e; e >>= 1, a = mulMod(a, a, i)) {
+                if (e & 1) r = mulMod(r, a, i);
+            }
+            return r;
+        }
+
+        // inv[j][i] = p_j^{-1} mod p_i（j < i）
+        static const std::array<std::array<uint64_t, K>, K>& inverses() {
+            static const auto table = [] {
+                std::array<std::array<uint64_t, K>, K> t{};
+                for (size_t j = 0; j < K; j++) {
+                    for (size_t i = j + 1; i < K; i++) {
+                        t[j][i] = powMod(prime(j) % prime(i), prime(i) - 2, i);
+                    }
+                }
+                return t;
+            }();
+            return table;
+        }
+};
+
+#endif // MOD_COUNT_H
@@ -0,0 +1,163 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// 对象池的累计统计：requests 为申请对象的次数，heapAllocs 为实际向堆申请内存块的次数
+struct PoolStats {
+    uint64_t requests = 0;
+    uint64_t heapAllocs = 0;
+};
+
+// 按线程缓存的定长对象池，供类的 operator new / delete 使用。
+// 释放的对象挂到当前线程的空闲链上，空闲链为空时一次向堆申请 SLAB 个对象的内存块；
+// 对象可以在一个线程申请、在另一个线程释放（mdxd 中树在线程间移交），此时归入释放线程的空闲链。
+// 内存块直到进程退出才归还，线程退出时其空闲链随之丢弃。
+// 线程局部状态只有指针，没有析构函数，其他 thread_local 对象析构时释放节点也是安全的。
+template <typename T, size_t SLAB = 256>
+class ObjectPool {
+    public:
+        static void* allocate() {
+            Local& l = local();
+            bump(counters(l).requests);
+            if (!l.head) refill(l);
+            Slot* s = l.head;
+            l.head = s->next;
+            return s;
+        }
+
+        static void release(void* p) {
+            if (!p) return;
+            Local& l = local();
+            Slot* s = static_cast<Slot*>(p);
+            s->next = l.head;
+            l.head = s;
+        }
+
+        // 所有线程的累计值
+        static PoolStats stats() {
+            PoolStats total;
+            std::lock_guard<std::mutex> lock(registryMutex());
+            for (const Counters* c : registry()) {
+                total.requests += c->requests.load(std::memory_order_relaxed);
+                total.heapAllocs += c->heapAllocs.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+    private:
+        union Slot {
+            Slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        // 计数器只由所属线程写入，其他线程汇总时只读，用 relaxed 原子避免数据竞争又不引入 RMW 开销
+        struct Counters {
+            std::atomic<uint64_t> requests{0};
+            std::atomic<uint64_t> heapAllocs{0};
+        };
+
+        struct Local {
+            Slot* head;
+            Counters* counters;
+        };
+
+        static Local& local() {
+            thread_local Local l{nullptr, nullptr};
+            return l;
+        }
+
+        static void bump(std::atomic<uint64_t>& c) {
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // 计数器首次使用时登记到全局表，随进程存活
+        static Counters& counters(Local& l) {
+            if (!l.counters) {
+                l.counters = new Counters();
+                std::lock_guard<std::mutex> lock(registryMutex());
+                registry().push_back(l.counters);
+            }
+            return *l.counters;
+        }
+
+        static void refill(Local& l) {
+            bump(counters(l).heapAllocs);
+            Slot* slab = static_cast<Slot*>(::operator new(sizeof(Slot) * SLAB));
+            for (size_t i = 0; i < SLAB; i++) {
+                slab[i].next = l.head;
+                l.head = &slab[i];
+            }
+        }
+
+        // 有意不析构，避免静态对象析构顺序问题
+        static std::mutex& registryMutex() {
+            static std::mutex* m = new std::mutex();
+            return *m;
+        }
+        static std::vector<Counters*>& registry() {
+            static std::vector<Counters*>* r = new std::vector<Counters*>();
+            return *r;
+        }
+};
+
+// 定长字节块，按大小分级复用 ObjectPool
+template <size_t BYTES>
+struct alignas(alignof(std::max_align_t)) PoolChunk {
+    unsigned char bytes[BYTES];
+};
+
+// 不超过 4KB 的请求按 2 的幂分级（最小 16 字节）从线程局部对象池取，更大的直接走 operator new。
+// 大于 256 字节的分级多是稠密顶点邻接表的桶数组，内存块取小一些
+inline void* poolAllocateBytes(size_t bytes) {
+    if (bytes <= 16) return ObjectPool<PoolChunk<16>>::allocate();
+    if (bytes <= 32) return ObjectPool<PoolChunk<32>>::allocate();
+    if (bytes <= 64) return ObjectPool<PoolChunk<64>>::allocate();
+    if (bytes <= 128) return ObjectPool<PoolChunk<128>>::allocate();
+    if (bytes <= 256) return ObjectPool<PoolChunk<256>>::allocate();
+    if (bytes <= 512) return ObjectPool<PoolChunk<512>, 32>::allocate();
+    if (bytes <= 1024) return ObjectPool<PoolChunk<1024>, 32>::allocate();
+    if (bytes <= 2048) return ObjectPool<PoolChunk<2048>, 32>::allocate();
+    if (bytes <= 4096) return ObjectPool<PoolChunk<4096>, 32>::allocate();
+    return ::operator new(bytes);
+}
+
+inline void poolReleaseBytes(void* p, size_t bytes) {
+    if (bytes <= 16) ObjectPool<PoolChunk<16>>::release(p);
+    else if (bytes <= 32) ObjectPool<PoolChunk<32>>::release(p);
+    else if (bytes <= 64) ObjectPool<PoolChunk<64>>::release(p);
+    else if (bytes <= 128) ObjectPool<PoolChunk<128>>::release(p);
+    else if (bytes <= 256) ObjectPool<PoolChunk<256>>::release(p);
+    else if (bytes <= 512) ObjectPool<PoolChunk<512>, 32>::release(p);
+    else if (bytes <= 1024) ObjectPool<PoolChunk<1024>, 32>::release(p);
+    else if (bytes <= 2048) ObjectPool<PoolChunk<2048>, 32>::release(p);
+    else if (bytes <= 4096) ObjectPool<PoolChunk<4096>, 32>::release(p);
+    else ::operator delete(p);
+}
+
+// 供标准容器使用的无状态分配器：哈希表节点和小表的桶数组都落在分级对象池里，
+// 容器反复插入删除时不再调用 malloc
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+    static_assert(alignof(T) <= alignof(std::max_align_t), "PoolAllocator 不支持超对齐类型");
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(poolAllocateBytes(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) noexcept { poolReleaseBytes(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+#endif // OBJECT_POOL_H
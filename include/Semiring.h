@@ -0,0 +1,145 @@
+#ifndef SEMIRING_H
+#define SEMIRING_H
+
+#include <climits>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "DnnfStore.h"
+
+// 行权重：从旁路文件读取，每行 "row weight"（行号从 1 开始），# 或 c 开头的行为注释。
+// 未列出的行取所在半环的单位元（权重 1 或代价 0），即对结果没有影响。
+class RowWeights {
+    public:
+        RowWeights() = default;
+        explicit RowWeights(int numRows) : weight_(numRows, 0.0), given_(numRows, false) {}
+
+        static RowWeights load(const std::string& path, int numRows);
+
+        // 实例旁的默认权重文件：与实例同目录、同名、扩展名为 .weights
+        static std::string defaultPath(const std::string& instancePath);
+
+        void set(int row, double w) { weight_[row] = w; given_[row] = true; }
+        bool has(int row) const { return row >= 0 && row < (int)given_.size() && given_[row]; }
+        double get(int row) const { return weight_[row]; }
+        int size() const { return static_cast<int>(weight_.size()); }
+
+    private:
+        std::vector<double> weight_;
+        std::vector<bool> given_;
+};
+
+// 半环：zero 为 FALSE 的值，one 为 TRUE 的值；决策节点 (r, lo, hi) 的值为 lo ⊕ (w_r ⊗ hi)，AND 节点为子节点值之积。
+// weighted 为 false 的计数半环忽略行权重，搜索中省去 ⊗ w_r，与直接计数的代码相同。
+// selective 的半环（⊕ 总是取两者之一）可以回溯出取到最优值的解。
+// DXD 搜索与电路求值都以半环为模板参数，见 DanceDNNF::DXD 与 evaluateCircuit。
+struct CountSemiring {
+    using value_type = DNNFResult;
+    static constexpr bool weighted = false;
+    static constexpr bool selective = false;
+    static const char* name() { return "count"; }
+    static value_type zero() { return DNNFResult(0); }
+    static value_type one() { return DNNFResult(1); }
+    static value_type weight(double) { return DNNFResult(1); }  // 计数忽略权重
+    static value_type add(const value_type& a, const value_type& b) { return a + b; }
+    static value_type mul(const value_type& a, const value_type& b) { return a * b; }
+    static std::string toString(const value_type& v) { return v.toString(); }
+};
+
+// 多模数计数：结果按中国剩余定理还原，解数小于 2^ModCount::rep_type::BOUND_BITS 时精确
+struct ModCountSemiring {
+    using value_type = ModCount;
+    static constexpr bool weighted = false;
+    static constexpr bool selective = false;
+    static const char* name() { return "mod"; }
+    static value_type zero() { return ModCount(0); }
+    static value_type one() { return ModCount(1); }
+    static value_type weight(double) { return ModCount(1); }
+    static value_type add(const value_type& a, const value_type& b) { return a + b; }
+    static value_type mul(const value_type& a, const value_type& b) { return a * b; }
+    static std::string toString(const value_type& v) { return v.toString(); }
+};
+
+// 对数域计数：近似值，每个值 8 字节
+struct LogCountSemiring {
+    using value_type = LogCount;
+    static constexpr bool weighted = false;
+    static constexpr bool selective = false;
+    static const char* name() { return "log"; }
+    static value_type zero() { return LogCount(0); }
+    static value_type one() { return LogCount(1); }
+    static value_type weight(double) { return LogCount(1); }
+    static value_type add(const value_type& a, const value_type& b) { return a + b; }
+    static value_type mul(const value_type& a, const value_type& b) { return a * b; }
+    static std::string toString(const value_type& v) { return v.toString(); }
+};
+
+// 加权和：全部解的权重之积求和（权重可以是概率）
+struct WeightedSumSemiring {
+    using value_type = long double;
+    static constexpr bool weighted = true;
+    static constexpr bool selective = false;
+    static const char* name() { return "sum"; }
+    static value_type zero() { return 0.0L; }
+    static value_type one() { return 1.0L; }
+    static value_type weight(double w) { return w; }
+    static value_type add(value_type a, value_type b) { return a + b; }
+    static value_type mul(value_type a, value_type b) { return a * b; }
+    static std::string toString(value_type v);
+};
+
+// 最大积：权重之积最大的解（要求权重非负）
+struct MaxProductSemiring {
+    using value_type = long double;
+    static constexpr bool weighted = true;
+    static constexpr bool selective = true;
+    static const char* name() { return "maxprod"; }
+    static value_type zero() { return 0.0L; }
+    static value_type one() { return 1.0L; }
+    static value_type weight(double w) { return w; }
+    static value_type add(value_type a, value_type b) { return a < b ? b : a; }
+    static value_type mul(value_type a, value_type b) { return a * b; }
+    // a 不劣于 b
+    static bool atLeast(value_type a, value_type b) { return a >= b; }
+    static std::string toString(value_type v);
+};
+
+// 最小和：代价之和最小的解，即最便宜的精确覆盖
+struct MinSumSemiring {
+    using value_type = long double;
+    static constexpr bool weighted = true;
+    static constexpr bool selective = true;
+    static const char* name() { return "minsum"; }
+    static value_type zero() { return std::numeric_limits<long double>::infinity(); }
+    static value_type one() { return 0.0L; }
+    static value_type weight(double w) { return w; }
+    static value_type add(value_type a, value_type b) { return b < a ? b : a; }
+    static value_type mul(value_type a, value_type b) { return a + b; }
+    static bool atLeast(value_type a, value_type b) { return a <= b; }
+    static std::string toString(value_type v);
+};
+
+// 行 row 在半环 S 中的权重，未给出时为单位元
+template <typename S>
+typename S::value_type rowWeight(const RowWeights& weights, int row) {
+    return weights.has(row) ? S::weight(weights.get(row)) : S::one();
+}
+
+// 在以 root 为根的电路上按半环 S 求值，一次线性扫描。
+// S 为 selective 且 witness 非空时，回溯出取到该值的一个解（行号从 0 开始，升序）。
+// 模板定义在 Semiring.cpp 中，为以上各半环显式实例化。
+template <typename S>
+typename S::value_type evaluateCircuit(const DnnfStore& store, dnnf_id root, const RowWeights& weights,
+                                       std::vector<int>* witness = nullptr);
+
+bool isKnownSemiring(const std::string& name);
+// 计数类半环（count / mod / log）不读取行权重
+bool semiringUsesWeights(const std::string& name);
+
+// 按名称（count / mod / log / sum / maxprod / minsum）选择半环求值，返回结果的文本形式
+std::string evaluateCircuitByName(const std::string& semiring, const DnnfStore& store, dnnf_id root,
+                                  const RowWeights& weights, std::vector<int>* witness = nullptr);
+
+#endif // SEMIRING_H
@@ -6,6 +6,9 @@
 #include <unordered_set>
 #include <memory>
 #include <algorithm>
+#include <cstdint>
+
+#include "ObjectPool.h"
 
 namespace splaytree {
 
@@ -15,16 +18,26 @@ struct Node {
     int v;                         // 结束顶点（-1表示单个顶点节点）
     Node *left, *right, *parent;
     int size;
+    int nt;                        // 顶点节点：该顶点在本层森林中层级恰为本层的非树边数；边节点恒为 0
+    int ntSum;                     // 子树内 nt 之和，与 size 一起维护
+    int te;                        // 边节点：树边层级恰为本层时，u < v 的那个出现记 1，其余为 0
+    int teSum;                     // 子树内 te 之和
+    int level;                     // 边节点：该树边的层级，以第 0 层森林中的节点为准
     
     // 构造单个顶点节点
     Node(int vertex) : u(vertex), v(-1), left(nullptr), 
-          right(nullptr), parent(nullptr), size(1) {}
+          right(nullptr), parent(nullptr), size(1), nt(0), ntSum(0), te(0), teSum(0), level(0) {}
     
-    // 构造边节点
+    // 构造边节点，新树边的层级为 0
     Node(int _u, int _v) : u(_u), v(_v), left(nullptr), 
-          right(nullptr), parent(nullptr), size(1) {}
+          right(nullptr), parent(nullptr), size(1), nt(0), ntSum(0),
+          te(_u < _v ? 1 : 0), teSum(te), level(0) {}
     
     bool isEdge() const { return v != -1; }
+
+    // 回溯时 link / cut 反复创建与删除节点，统一从线程局部对象池分配
+    static void* operator new(size_t) { return ObjectPool<Node>::allocate(); }
+    static void operator delete(void* p) { ObjectPool<Node>::release(p); }
 };
 
 // 边的表示（标准化：u < v）
@@ -49,6 +62,16 @@ struct EdgeHash {
     }
 };
 
+// 树内的哈希容器都用对象池分配器，节点与小桶数组在线程内复用
+template <typename T>
+using PooledSet = std::unordered_set<T, std::hash<T>, std::equal_to<T>, PoolAllocator<T>>;
+template <typename K, typename V>
+using PooledMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, PoolAllocator<std::pair<const K, V>>>;
+// 顶点 -> (顶点 -> 节点)：[v][v] 为顶点节点，[u][v] 为树边 (u, v) 的出现
+using NodeTable = PooledMap<int, PooledMap<int, Node*>>;
+// 顶点 -> 非树边邻居集合，每条边在两端各存一份
+using AdjTable = PooledMap<int, PooledSet<int>>;
+
 // struct EdgeOrder {
 //     Node* first;   // 在欧拉序列中先出现的边节点
 //     Node* second;  // 在欧拉序列中后出现的边节点
@@ -66,25 +89,47 @@ public:
     int  compId   = -1;
     
     // 连通分量信息
-    std::unordered_set<int> vertices;                          // 顶点集合
-    std::unordered_set<Edge, EdgeHash> nonTreeEdges;           // 非树边集合
+    PooledSet<int> vertices;                                   // 顶点集合
+    // 非树边按顶点存邻接：顶点 -> 邻居集合，每条边在两端各存一份
+    AdjTable nonTreeAdj;
     
     // 每个顶点的occurrence节点列表（用于O(1)查找）
     // std::unordered_map<int, std::vector<Node*>> vertexOccurrences;
     // 存储所有树边节点，便于快速查找和更新
-    std::unordered_map<int, std::unordered_map<int, Node*>> edgeNodes;
+    NodeTable edgeNodes;
+
+    // HDT 分层：第 i 层森林 F_i 由层级不低于 i 的树边构成，F_0 ⊇ F_1 ⊇ …。
+    // 第 0 层就是上面的 root / edgeNodes / nonTreeAdj，这里存 i >= 1 的各层：
+    // nodes 同 edgeNodes，nonTreeAdj 只含层级恰为 i 的非树边。顶点用到时才在高层建节点
+    struct LevelForest {
+        NodeTable nodes;
+        AdjTable nonTreeAdj;
+    };
+    std::vector<LevelForest> upperLevels;                      // upperLevels[i - 1] 即 F_i
+
+    // 顶点 -> 所在树的路由表（按顶点编号下标），由持有这些树的线程状态拥有。
+    // 非空时，顶点加入、移除或随 link / cut 换树时由本类同步更新，调用方据此 O(1) 定位顶点所在的树。
+    std::vector<EulerTourTree*>* vertexIndex = nullptr;
 
     // std::unordered_map<Edge, EdgeOrder, EdgeHash> edgeOrder;
     
     // Splay树基本操作
-    void updateSize(Node* x);
-    void rotate(Node* n);
+    static void updateSize(Node* x);
+    static void rotate(Node* n);
     void splay(Node* n);
     void updateSizeToRoot(Node* n);
 
     Node* findMax(Node* x);
     Node* findMin(Node* x);
-    Node* findRoot(Node* x);
+    static Node* findRoot(Node* x);
+
+    // 各层森林共用的序列操作，不改动 root，返回结果序列的根
+    static void splayNode(Node* n);
+    static Node* joinNodes(Node* leftTree, Node* rightTree);
+    static Node* rerootNode(Node* n);
+    static Node* removeNode(Node* n);
+    // 沿 sum 下降到第一个 own > 0 的节点，调用方保证 r->*sum > 0
+    static Node* findMarked(Node* r, int Node::*own, int Node::*sum);
 
     Node* findRightmost(Node* x);
     Node* concatenate(Node* leftTree, Node* rightTree);
@@ -103,8 +148,28 @@ public:
     Node* buildFromNodes(std::vector<Node*>& nodes, int start, int end);
     void deleteTree(Node* x);
     
-    // 寻找替代边
-    Edge findReplacementEdge(Node* rootU, Node* rootV);
+    // 第 i 层的节点表 / 非树邻接，i 超出现有层数时补齐
+    NodeTable& levelNodes(int i);
+    AdjTable& levelAdj(int i);
+    int levelCount() const { return 1 + static_cast<int>(upperLevels.size()); }
+    // 顶点 x 在第 i 层的节点，没有则新建一个孤立节点
+    Node* levelVertex(int i, int x);
+    // 在第 i 层连上 / 删去层级为 level 的树边 (x, y)
+    void linkLevelEdge(int i, int x, int y, int level);
+    void cutLevelEdge(int i, int x, int y);
+
+    // 第 i 层的替代边搜索（树边 (u, v) 已从 F_0..F_i 删去）：只看 F_i 中较小一侧，
+    // 先把小侧层级为 i 的树边升到 i + 1 层，再按 ntSum 逐条取小侧层级为 i 的非树边，
+    // 两端都在小侧的升一层，第一条跨两侧的即为替代边（已从非树边中移除）
+    Edge findReplacementEdge(int i, int u, int v);
+
+    // 顶点 x 在第 level 层的非树边数加 delta，并把 x 的节点伸展到根以更新路径上的 ntSum
+    void adjustNonTreeDegree(int x, int delta, int level = 0);
+    // 不查重地加入 / 删去第 level 层的非树边
+    void insertNonTreeEdge(int level, const Edge& e);
+    bool eraseNonTreeEdge(int level, const Edge& e);
+    // 把顶点 x 在各层的节点与非树邻接整体移到 to，x 的边须都落在 to 一侧
+    void moveVertex(int x, EulerTourTree* to);
     
 public:
     explicit EulerTourTree(int id);
@@ -113,9 +178,25 @@ public:
     // 禁止拷贝，只能移动
     // EulerTourTree(const EulerTourTree&) = delete;
     // EulerTourTree& operator=(const EulerTourTree&) = delete;
+    // 拷贝不登记到路由表，需要时由调用方 attachIndex
     EulerTourTree(const EulerTourTree& o)
     : treeId(o.treeId), compId(o.compId), root(o.root),
-        vertices(o.vertices), nonTreeEdges(o.nonTreeEdges), edgeNodes(o.edgeNodes) {}
+        vertices(o.vertices), nonTreeAdj(o.nonTreeAdj), edgeNodes(o.edgeNodes),
+        upperLevels(o.upperLevels) {}
+
+    // IncUpdateCC 为每个恢复的顶点新建一棵树，合并后随即销毁，树对象本身也从对象池分配
+    static void* operator new(size_t) { return ObjectPool<EulerTourTree, 64>::allocate(); }
+    static void operator delete(void* p) { ObjectPool<EulerTourTree, 64>::release(p); }
+
+    // 回收的空树放进线程局部空闲表：清空内容但保留外层哈希表的桶数组，
+    // acquire 优先从中取用，新树不必重新申请对象与桶数组
+    static std::unique_ptr<EulerTourTree> acquire(int id);
+    static void recycle(std::unique_ptr<EulerTourTree> tree);
+    // 释放全部节点并注销路由，容器清空后保留容量
+    void clear();
+
+    // 改用路由表 index（可为 nullptr）：先从原表注销全部顶点，再登记到新表
+    void attachIndex(std::vector<EulerTourTree*>* index);
     
     // 基本操作
     int getTreeId() const { return treeId; }
@@ -133,10 +214,11 @@ public:
     
     // 查询操作
     bool isConnected(int u, int v) const;
-    void setVertices(const std::unordered_set<int>& verts) { vertices = verts; }
-    std::unordered_set<int> getVertices() const { return vertices; }
-    void setNonTreeEdges(const std::unordered_set<Edge, EdgeHash>& edges) { nonTreeEdges = edges; }
-    std::unordered_set<Edge, EdgeHash> getNonTreeEdges() const { return nonTreeEdges; }
+    void setVertices(const std::unordered_set<int>& verts) { vertices = PooledSet<int>(verts.begin(), verts.end()); }
+    std::unordered_set<int> getVertices() const { return std::unordered_set<int>(vertices.begin(), vertices.end()); }
+    // 需在顶点节点建好之后调用，否则节点上的非树边计数为 0。边一律放在第 0 层
+    void setNonTreeEdges(const std::unordered_set<Edge, EdgeHash>& edges);
+    std::unordered_set<Edge, EdgeHash> getNonTreeEdges() const;
     bool isEmpty() const { return vertices.empty(); }
     bool hasVertex(int v) const { return vertices.count(v) > 0; }
    
@@ -153,6 +235,18 @@ public:
         return vertices.count(v) > 0;
     }
 
+    // 在路由表中把 v 指向本树 / 注销 v（仍指向本树时）
+    inline void route(int v) {
+        if (!vertexIndex) return;
+        if (static_cast<size_t>(v) >= vertexIndex->size()) vertexIndex->resize(static_cast<size_t>(v) + 1, nullptr);
+        (*vertexIndex)[v] = this;
+    }
+    inline void unroute(int v) {
+        if (vertexIndex && static_cast<size_t>(v) < vertexIndex->size() && (*vertexIndex)[v] == this) {
+            (*vertexIndex)[v] = nullptr;
+        }
+    }
+
     // 快速获取边界顶点的树边邻居（如果存在）
     inline int getBoundaryVertexTreeNeighbor(int v) const {
         auto it = edgeNodes.find(v);
@@ -166,10 +260,19 @@ public:
         return -1;
     }
 
-    // 非树边操作
-    void addNonTreeEdge(const Edge& e) { nonTreeEdges.insert(e); }
-    void removeNonTreeEdge(const Edge& e) { nonTreeEdges.erase(e); }
-    bool hasNonTreeEdge(const Edge& e) const { return nonTreeEdges.count(e) > 0; }
+    // 非树边操作：新边放在第 0 层，删除时按所在层处理
+    void addNonTreeEdge(const Edge& e);
+    void removeNonTreeEdge(const Edge& e);
+    // 非树边 e 所在的层，不存在时为 -1
+    int nonTreeLevel(const Edge& e) const {
+        for (int i = 0; i < levelCount(); ++i) {
+            const auto& adj = (i == 0) ? nonTreeAdj : upperLevels[i - 1].nonTreeAdj;
+            auto it = adj.find(e.u);
+            if (it != adj.end() && it->second.count(e.v)) return i;
+        }
+        return -1;
+    }
+    bool hasNonTreeEdge(const Edge& e) const { return nonTreeLevel(e) >= 0; }
     bool isTreeEdge(int u, int v) const {
         if (u > v) std::swap(u, v);
         return edgeNodes.count(u) && edgeNodes.at(u).count(v);
@@ -0,0 +1,139 @@
+#include "../include/BigCount.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void BigCount::promote() {
+    if (!big_) big_.reset(new std::vector<uint64_t>(1, small_));
+}
+
+void BigCount::normalize() {
+    std::vector<uint64_t>& l = *big_;
+    while (l.size() > 1 && l.back() == 0) l.pop_back();
+    if (l.size() <= 1) {
+        small_ = l.empty() ? 0 : l[0];
+        big_.reset();
+    }
+}
+
+void BigCount::addSlow(const BigCount& o) {
+    promote();
+    std::vector<uint64_t>& a = *big_;
+    const uint64_t* b = o.big_ ? o.big_->data() : &o.small_;
+    size_t bn = o.big_ ? o.big_->size() : 1;
+    if (a.size() < bn) a.resize(bn, 0);
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        unsigned __int128 s = (unsigned __int128)a[i] + (i < bn ? b[i] : 0) + carry;
+        a[i] = static_cast<uint64_t>(s);
+        carry = static_cast<uint64_t>(s >> 64);
+        if (carry == 0 && i >= bn) break;
+    }
+    if (carry) a.push_back(carry);
+    normalize();
+}
+
+void BigCount::mulSlow(const BigCount& o) {
+    if (isZero() || o.isZero()) {
+        big_.reset();
+        small_ = 0;
+        return;
+    }
+    const uint64_t* a = big_ ? big_->data() : &small_;
+    size_t an = big_ ? big_->size() : 1;
+    const uint64_t* b = o.big_ ? o.big_->data() : &o.small_;
+    size_t bn = o.big_ ? o.big_->size() : 1;
+
+    // 乘积写入线程局部缓冲区，再拷回自身，避免 this 与 o 相同时互相覆盖
+    thread_local std::vector<uint64_t> out;
+    out.assign(an + bn, 0);
+    for (size_t i = 0; i < an; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < bn; j++) {
+            unsigned __int128 t = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
+            out[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+        out[i + bn] = carry;
+    }
+    if (big_) big_->assign(out.begin(), out.end());
+    else big_.reset(new std::vector<uint64_t>(out));
+    normalize();
+}
+
+BigCount& BigCount::operator-=(const BigCount& o) {
+    if (!big_ && !o.big_) {
+        small_ -= o.small_;
+        return *this;
+    }
+    promote();
+    std::vector<uint64_t>& a = *big_;
+    const uint64_t* b = o.big_ ? o.big_->data() : &o.small_;
+    size_t bn = o.big_ ? o.big_->size() : 1;
+
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a.size() && (i < bn || borrow); i++) {
+        uint64_t sub = (i < bn ? b[i] : 0);
+        uint64_t d = a[i] - sub - borrow;
+        borrow = (a[i] < sub || (a[i] - sub) < borrow) ? 1 : 0;
+        a[i] = d;
+    }
+    normalize();
+    return *this;
+}
+
+int BigCount::compareLimbs(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+int BigCount::compare(const BigCount& a, const BigCount& b) {
+    if (!a.big_ && !b.big_) {
+        return a.small_ < b.small_ ? -1 : (a.small_ > b.small_ ? 1 : 0);
+    }
+    if (!a.big_) return -1;  // 内联值总小于 2^64 <= 大整数
+    if (!b.big_) return 1;
+    return compareLimbs(*a.big_, *b.big_);
+}
+
+std::string BigCount::toString() const {
+    if (!big_) return std::to_string(small_);
+
+    // 反复除以 10^19，得到从低到高的十进制分段
+    const uint64_t BASE = 10000000000000000000ULL;
+    std::vector<uint64_t> n = *big_;
+    std::vector<uint64_t> parts;
+    while (!n.empty()) {
+        unsigned __int128 rem = 0;
+        for (size_t i = n.size(); i-- > 0;) {
+            unsigned __int128 cur = (rem << 64) | n[i];
+            n[i] = static_cast<uint64_t>(cur / BASE);
+            rem = cur % BASE;
+        }
+        parts.push_back(static_cast<uint64_t>(rem));
+        while (!n.empty() && n.back() == 0) n.pop_back();
+    }
+
+    std::string s = std::to_string(parts.back());
+    for (size_t i = parts.size() - 1; i-- > 0;) {
+        std::string p = std::to_string(parts[i]);
+        s.append(19 - p.size(), '0');
+        s += p;
+    }
+    return s;
+}
+
+double BigCount::log10() const {
+    if (isZero()) return -std::numeric_limits<double>::infinity();
+    if (!big_) return std::log10(static_cast<double>(small_));
+    // 取最高两个 limb 估计
+    const std::vector<uint64_t>& l = *big_;
+    size_t n = l.size();
+    long double top = (long double)l[n - 1] * 18446744073709551616.0L + (long double)l[n - 2];
+    return static_cast<double>(std::log10(top) + (n - 2) * 64 * std::log10(2.0L));
+}
@@ -525,25 +525,55 @@ std::vector<Block> ComponentDetector::convertComponentsToBlocks(
 // };
 
 
-std::vector<int> Graph::getNeighbors(int v) const {
-    // chk(v);
-    std::vector<int> res;
-    for (AdjNode* c = vertices_[v].sentinel.next; c; c = c->next)
-        if (!c->deleted && !vertices_[c->neighbor].deleted)
-            res.push_back(c->neighbor);
-    return res;
+void Graph::addEdge(int u, int v) {
+    chk(u); chk(v);
+    if (deleted_) {
+        int s = slotOf(u, v);
+        if (s >= 0) { restoreEdge(u, v); return; }
+    }
+    pending_.emplace_back(std::min(u, v), std::max(u, v));
+    if (deleted_) finalize();
 }
 
-std::vector<int> Graph::getAllNeighbors(int v) const {
-    // chk(v);
-    std::vector<int> res;
-    for (AdjNode* c = vertices_[v].sentinel.next; c; c = c->next)
-        res.push_back(c->neighbor);   // 不检查 deleted，全部返回
-    return res;
-}
+void Graph::finalize() {
+    const int n = numVertices();
+
+    // 已有 CSR 中的边连同删除标记一并重建
+    std::vector<std::pair<int, int>> removed;
+    for (int u = 0; u < n && deleted_; u++) {
+        for (uint32_t s = offsets_[u]; s < offsets_[u + 1]; s++) {
+            int v = adj_[s];
+            if (u >= v) continue;
+            pending_.emplace_back(u, v);
+            if (slotDeleted(s)) removed.emplace_back(u, v);
+        }
+    }
+
+    std::sort(pending_.begin(), pending_.end());
+    pending_.erase(std::unique(pending_.begin(), pending_.end()), pending_.end());
+
+    std::fill(offsets_.begin(), offsets_.end(), 0);
+    for (auto [u, v] : pending_) {
+        offsets_[u + 1]++;
+        offsets_[v + 1]++;
+    }
+    for (int v = 0; v < n; v++) offsets_[v + 1] += offsets_[v];
 
-int Graph::getDegree(int v) const {
-    return getNeighbors(v).size();
+    adj_.assign(offsets_[n], 0);
+    std::vector<uint32_t> fill(offsets_.begin(), offsets_.end() - 1);
+    for (auto [u, v] : pending_) {
+        adj_[fill[u]++] = v;
+        adj_[fill[v]++] = u;
+    }
+    for (int v = 0; v < n; v++) {
+        std::sort(adj_.begin() + offsets_[v], adj_.begin() + offsets_[v + 1]);
+    }
+    std::vector<std::pair<int, int>>().swap(pending_);
+
+    size_t words = adj_.size() / 64 + 1;
+    deleted_.reset(new std::atomic<uint64_t>[words]);
+    for (size_t w = 0; w < words; w++) deleted_[w].store(0, std::memory_order_relaxed);
+    for (auto [u, v] : removed) deleteEdge(u, v);
 }
 
 // ─────────────────────────────────────────────
@@ -557,27 +587,31 @@ int Graph::getDegree(int v) const {
  void SubGraph::restoreVertex(int v)  { parent_->restoreVertex(v); }
  bool SubGraph::hasVertex  (int v)    const { return parent_->hasVertex(v); }
 
- std::vector<int> SubGraph::neighbors(int v) const {
+ VertexRange SubGraph::vertices() const {
+    return parent_->componentVertices(offset_, count_);
+}
+
+ VertexRange SubGraph::neighbors(int v) const {
     return parent_->getNeighbors(v);
 }
 
- std::vector<int> SubGraph::getAllNeighbors(int v) const {
+ VertexRange SubGraph::getAllNeighbors(int v) const {
     return parent_->getAllNeighbors(v);
 }
 
  void SubGraph::print() const {
     std::cout << "  SubGraph[" << compId_ << "] (" << size() << "v): ";
-    for (int v : vertexIds_) {
+    for (int v : vertices()) {
         std::cout << "v" << v << "(";
         bool first = true;
-        for (AdjNode* c = parent_->vertex(v).sentinel.next; c; c = c->next) {
-            if (!c->deleted && parent_->vertex(c->neighbor).compId == compId_) {
+        for (int u : parent_->getNeighbors(v)) {
+            if (parent_->vertex(u).compId == compId_) {
                 if (!first) std::cout << ",";
-                std::cout << c->neighbor;
+                std::cout << u;
                 first = false;
             }
         }
         std::cout << ") ";
     }
     std::cout << "\n";
-}
\ No newline at end of file
+}
@@ -0,0 +1,394 @@
+#include "../include/CountCache.h"
+
+#include <cstring>
+
+CacheMode parseCacheMode(const std::string& name) {
+    if (name == "fingerprint") return CacheMode::Fingerprint;
+    if (name == "verified") return CacheMode::Verified;
+    throw std::invalid_argument("Unknown cache mode: " + name);
+}
+
+std::string cacheModeName(CacheMode mode) {
+    return mode == CacheMode::Fingerprint ? "fingerprint" : "verified";
+}
+
+size_t parseMemorySize(const std::string& text) {
+    size_t pos = 0;
+    double value = std::stod(text, &pos);
+    std::string unit = text.substr(pos);
+    if (!unit.empty() && (unit.back() == 'B' || unit.back() == 'b')) unit.pop_back();
+
+    double scale = 1024.0 * 1024.0;  // 默认 MB
+    if (unit == "K" || unit == "k") scale = 1024.0;
+    else if (unit == "G" || unit == "g") scale = 1024.0 * 1024.0 * 1024.0;
+    else if (!unit.empty() && unit != "M" && unit != "m") {
+        throw std::invalid_argument("Invalid memory size: " + text);
+    }
+    if (value < 0) throw std::invalid_argument("Invalid memory size: " + text);
+    return static_cast<size_t>(value * scale);
+}
+
+template <typename Value>
+const std::vector<uint8_t>& BasicCountCache<Value>::encode(const SparseSet& cols) {
+    thread_local std::vector<int> sorted;
+    thread_local std::vector<uint8_t> key;
+
+    sorted.assign(cols.begin(), cols.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    // 升序列号的差分序列，每个差值按 7 位一组写成 varint
+    key.clear();
+    int prev = 0;
+    for (int c : sorted) {
+        uint32_t delta = static_cast<uint32_t>(c - prev);
+        prev = c;
+        while (delta >= 0x80) {
+            key.push_back(static_cast<uint8_t>(delta | 0x80));
+            delta >>= 7;
+        }
+        key.push_back(static_cast<uint8_t>(delta));
+    }
+    return key;
+}
+
+template <typename Value>
+BasicCountCache<Value>::BasicCountCache(CacheMode mode, size_t shards) : mode_(mode) {
+    shardCount_ = 1;
+    shardShift_ = 64;
+    while (shardCount_ < shards) {
+        shardCount_ <<= 1;
+        shardShift_--;
+    }
+    shards_.reset(new Shard[shardCount_]);
+}
+
+template <typename Value>
+BasicCountCache<Value>::~BasicCountCache() = default;
+
+template <typename Value>
+void BasicCountCache<Value>::setBudget(size_t bytes) {
+    budget_ = bytes;
+    size_t perShard = bytes ? std::max<size_t>(1, bytes / shardCount_) : 0;
+    for (size_t i = 0; i < shardCount_; i++) {
+        Shard& shard = shards_[i];
+        std::unique_lock<std::shared_mutex> writeLock(shard.mutex);
+        shard.budget = perShard;
+        if (perShard == 0) continue;
+
+        // 预算调小时立即淘汰到新预算以内；数组容量本身超出预算时只能清空分片
+        while (residentBytes(shard) > perShard) {
+            if (shard.deadKeyBytes > 0) compactKeys(shard);
+            else if (shard.liveEntries > 0) evictNext(shard);
+            else {
+                release(shard);
+                break;
+            }
+        }
+    }
+}
+
+template <typename Value>
+uint8_t BasicCountCache<Value>::weightOf(size_t numCols) {
+    // 1 + floor(log2(列数))，子问题越大重新计算越昂贵
+    uint8_t w = 1;
+    while (numCols > 1 && w < MAX_CREDIT) {
+        numCols >>= 1;
+        w++;
+    }
+    return w;
+}
+
+template <typename Value>
+bool BasicCountCache<Value>::sameKey(const Shard& shard, const Entry& e, const std::vector<uint8_t>& key) {
+    return e.keyLength == key.size() &&
+           std::memcmp(shard.keyPool.data() + e.keyOffset, key.data(), key.size()) == 0;
+}
+
+template <typename Value>
+void BasicCountCache<Value>::touch(const Shard& shard, Entry& e) {
+    if (shard.budget == 0) return;
+    if (e.credit.load(std::memory_order_relaxed) < e.weight) {
+        e.credit.store(e.weight, std::memory_order_relaxed);
+    }
+}
+
+template <typename Value>
+bool BasicCountCache<Value>::lookup(uint64_t hash, const SparseSet& cols, Value& out, dnnf_id& node) {
+    bool verified = mode_ == CacheMode::Verified;
+    const std::vector<uint8_t>* key = verified ? &encode(cols) : nullptr;
+    Shard& shard = shardOf(hash);
+
+    std::shared_lock<std::shared_mutex> readLock(shard.mutex);
+    auto it = shard.index.find(hash);
+    if (it == shard.index.end()) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (uint32_t i = it->second; i != NIL; i = shard.entries[i].next) {
+        Entry& e = shard.entries[i];
+        if (!verified || sameKey(shard, e, *key)) {
+            out = e.value;
+            node = e.node;
+            touch(shard, e);
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    shard.collisions.fetch_add(1, std::memory_order_relaxed);
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+template <typename Value>
+void BasicCountCache<Value>::insert(uint64_t hash, const SparseSet& cols, const Value& value, dnnf_id node) {
+    bool verified = mode_ == CacheMode::Verified;
+    const std::vector<uint8_t>* key = verified ? &encode(cols) : nullptr;
+    uint32_t keyLength = verified ? static_cast<uint32_t>(key->size()) : 0;
+    Shard& shard = shardOf(hash);
+
+    std::unique_lock<std::shared_mutex> writeLock(shard.mutex);
+    auto it = shard.index.find(hash);
+    if (it != shard.index.end()) {
+        for (uint32_t i = it->second; i != NIL; i = shard.entries[i].next) {
+            if (!verified || sameKey(shard, shard.entries[i], *key)) {
+                shard.entries[i].value = value;
+                shard.entries[i].node = node;
+                return;
+            }
+        }
+    }
+
+    // 超出预算时先淘汰，淘汰可能改动本哈希的碰撞链，之后重新查找
+    if (shard.budget > 0) {
+        if (!makeRoom(shard, keyLength)) return;
+        it = shard.index.find(hash);
+    }
+
+    uint32_t id;
+    if (shard.freeHead != NIL) {
+        id = shard.freeHead;
+        shard.freeHead = shard.entries[id].next;
+    } else {
+        id = static_cast<uint32_t>(shard.entries.size());
+        shard.entries.emplace_back();
+    }
+
+    Entry& e = shard.entries[id];
+    e.hash = hash;
+    e.keyOffset = shard.keyPool.size();
+    e.keyLength = keyLength;
+    e.next = (it != shard.index.end()) ? it->second : NIL;
+    e.weight = weightOf(cols.size());
+    e.live = true;
+    e.credit.store(e.weight, std::memory_order_relaxed);
+    e.value = value;
+    e.node = node;
+    if (verified) shard.keyPool.insert(shard.keyPool.end(), key->begin(), key->end());
+
+    shard.index[hash] = id;
+    shard.liveEntries++;
+
+    if (shard.deadKeyBytes > COMPACT_MIN_DEAD_BYTES && shard.deadKeyBytes * 2 > shard.keyPool.size()) {
+        compactKeys(shard);
+    }
+}
+
+template <typename Value>
+bool BasicCountCache<Value>::makeRoom(Shard& shard, uint32_t keyLength) {
+    if (entryBytes(keyLength) > shard.budget) return false;
+
+    // 淘汰不会缩小数组容量，只释放槽位与键字节，因此扩容量受剩余预算限制，
+    // 失效键由压缩回收；每一步要么扩容、要么压缩、要么淘汰一个条目，循环必然结束
+    while (true) {
+        size_t used = residentBytes(shard) + INDEX_OVERHEAD;  // 计入新条目的索引开销
+        size_t spare = used < shard.budget ? shard.budget - used : 0;
+        bool slotReady = shard.freeHead != NIL || shard.entries.size() < shard.entries.capacity();
+        bool keyReady = shard.keyPool.size() + keyLength <= shard.keyPool.capacity();
+        if (used <= shard.budget && slotReady && keyReady) return true;
+
+        if (!slotReady && spare >= sizeof(Entry)) {
+            size_t cap = shard.entries.capacity();
+            shard.entries.reserve(cap + std::min(std::max<size_t>(cap, 16), spare / sizeof(Entry)));
+            continue;
+        }
+
+        // 失效键不足键池的四分之一时先继续淘汰，使每次压缩至少回收四分之一，压缩代价均摊为常数
+        bool worthCompacting = shard.deadKeyBytes * 4 >= shard.keyPool.size() || shard.liveEntries == 0;
+        if ((!keyReady || used > shard.budget) && shard.deadKeyBytes > 0 && worthCompacting) {
+            // 压缩后留出一半存活键大小的余量，避免每次淘汰后都重新压缩
+            size_t live = shard.keyPool.size() - shard.deadKeyBytes + keyLength;
+            size_t rest = used - shard.keyPool.capacity();
+            size_t room = rest + live < shard.budget ? shard.budget - rest - live : 0;
+            compactKeys(shard, keyLength + std::min(live / 2, room));
+            continue;
+        }
+
+        if (!keyReady) {
+            size_t cap = shard.keyPool.capacity();
+            size_t need = shard.keyPool.size() + keyLength - cap;
+            if (spare >= need) {
+                shard.keyPool.reserve(cap + std::min(std::max(cap, need), spare));
+                continue;
+            }
+        }
+
+        if (shard.liveEntries > 0) {
+            evictNext(shard);
+            continue;
+        }
+
+        // 没有存活条目仍放不下（预算被调小）：释放全部容量后重新扩容
+        if (shard.entries.capacity() == 0 && shard.keyPool.capacity() == 0) return false;
+        release(shard);
+    }
+}
+
+template <typename Value>
+void BasicCountCache<Value>::evictNext(Shard& shard) {
+    // 加权 CLOCK：指针扫过时权重减一，淘汰遇到的第一个权重为 0 的条目
+    while (true) {
+        if (shard.clockHand >= shard.entries.size()) shard.clockHand = 0;
+
+        uint32_t id = static_cast<uint32_t>(shard.clockHand++);
+        Entry& e = shard.entries[id];
+        if (!e.live) continue;
+
+        uint8_t credit = e.credit.load(std::memory_order_relaxed);
+        if (credit > 0) {
+            e.credit.store(credit - 1, std::memory_order_relaxed);
+        } else {
+            evict(shard, id);
+            return;
+        }
+    }
+}
+
+template <typename Value>
+void BasicCountCache<Value>::release(Shard& shard) {
+    std::unordered_map<uint64_t, uint32_t>().swap(shard.index);
+    std::vector<Entry>().swap(shard.entries);
+    std::vector<uint8_t>().swap(shard.keyPool);
+    shard.freeHead = NIL;
+    shard.liveEntries = 0;
+    shard.deadKeyBytes = 0;
+    shard.clockHand = 0;
+}
+
+template <typename Value>
+void BasicCountCache<Value>::evict(Shard& shard, uint32_t id) {
+    Entry& e = shard.entries[id];
+
+    auto it = shard.index.find(e.hash);
+    if (it->second == id) {
+        if (e.next == NIL) shard.index.erase(it);
+        else it->second = e.next;
+    } else {
+        uint32_t prev = it->second;
+        while (shard.entries[prev].next != id) prev = shard.entries[prev].next;
+        shard.entries[prev].next = e.next;
+    }
+
+    shard.liveEntries--;
+    shard.deadKeyBytes += e.keyLength;
+    e.live = false;
+    e.next = shard.freeHead;
+    shard.freeHead = id;
+    shard.evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Value>
+void BasicCountCache<Value>::compactKeys(Shard& shard, size_t extra) {
+    std::vector<uint8_t> pool;
+    pool.reserve(shard.keyPool.size() - shard.deadKeyBytes + extra);
+    for (Entry& e : shard.entries) {
+        if (!e.live) continue;
+        uint64_t offset = pool.size();
+        pool.insert(pool.end(), shard.keyPool.begin() + e.keyOffset,
+                    shard.keyPool.begin() + e.keyOffset + e.keyLength);
+        e.keyOffset = offset;
+    }
+    shard.keyPool.swap(pool);
+    shard.deadKeyBytes = 0;
+}
+
+template <typename Value>
+void BasicCountCache<Value>::clear() {
+    for (size_t i = 0; i < shardCount_; i++) {
+        Shard& shard = shards_[i];
+        std::unique_lock<std::shared_mutex> writeLock(shard.mutex);
+        release(shard);
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.collisions = 0;
+        shard.evictions = 0;
+    }
+}
+
+template <typename Value>
+template <typename F>
+uint64_t BasicCountCache<Value>::sumShards(F f) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shardCount_; i++) {
+        std::shared_lock<std::shared_mutex> readLock(shards_[i].mutex);
+        total += f(shards_[i]);
+    }
+    return total;
+}
+
+template <typename Value>
+size_t BasicCountCache<Value>::entries() const {
+    return sumShards([](const Shard& s) { return s.liveEntries; });
+}
+
+template <typename Value>
+size_t BasicCountCache<Value>::keyBytes() const {
+    return sumShards([](const Shard& s) { return s.keyPool.size() - s.deadKeyBytes; });
+}
+
+template <typename Value>
+size_t BasicCountCache<Value>::memoryBytes() const {
+    return sumShards([](const Shard& s) { return residentBytes(s); });
+}
+
+template <typename Value>
+uint64_t BasicCountCache<Value>::hits() const {
+    return sumShards([](const Shard& s) { return s.hits.load(std::memory_order_relaxed); });
+}
+
+template <typename Value>
+uint64_t BasicCountCache<Value>::misses() const {
+    return sumShards([](const Shard& s) { return s.misses.load(std::memory_order_relaxed); });
+}
+
+template <typename Value>
+uint64_t BasicCountCache<Value>::collisions() const {
+    return sumShards([](const Shard& s) { return s.collisions.load(std::memory_order_relaxed); });
+}
+
+template <typename Value>
+uint64_t BasicCountCache<Value>::evictions() const {
+    return sumShards([](const Shard& s) { return s.evictions.load(std::memory_order_relaxed); });
+}
+
+template <typename Value>
+std::string BasicCountCache<Value>::summary() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "Cache: mode=" << cacheModeName(mode_)
+        << " entries=" << entries()
+        << " hits=" << hits()
+        << " misses=" << misses()
+        << " evictions=" << evictions()
+        << " collisions=" << collisions()
+        << " keyBytes=" << keyBytes()
+        << " memory=" << memoryBytes() / (1024.0 * 1024.0) << "MB";
+    if (budget_ > 0) oss << " budget=" << budget_ / (1024.0 * 1024.0) << "MB";
+    else oss << " budget=unlimited";
+    return oss.str();
+}
+
+template class BasicCountCache<DNNFResult>;
+template class BasicCountCache<ModCount>;
+template class BasicCountCache<LogCount>;
+template class BasicCountCache<long double>;
@@ -1,28 +1,20 @@
 #include "../include/DXD.h"
+#include "../include/DnnfEnumerator.h"
+#include "../include/DnnfSampler.h"
+#include "../include/Semiring.h"
 
-shared_ptr<DNNFNode> DanceDNNF::buildDecisionNode(int r, shared_ptr<DNNFNode> lo, shared_ptr<DNNFNode> hi) {
-    if (hi == F) {
+dnnf_id DanceDNNF::buildDecisionNode(int r, dnnf_id lo, dnnf_id hi) {
+    if (hi == DnnfStore::FALSE_ID) {
         return lo;
     }
 
-    size_t key = gen_key(r, lo.get(), hi.get());
-
-    {    
-        std::shared_lock<std::shared_mutex> readLock(tableMutex);
-        auto it = node_table.find(key);
-        if (it != node_table.end()) {
-            return it->second;
-        }
-    }
-
-    std::unique_lock<std::shared_mutex> writeLock(tableMutex);
-    if (node_table.find(key) != node_table.end()) {
-        return node_table[key];
+    std::lock_guard<std::mutex> lock(tableMutex);
+    bool created = false;
+    dnnf_id decision_node = dnnf.makeDecision(r, lo, hi, &created);
+    if (!created) {
+        return decision_node;
     }
 
-    auto decision_node = make_shared<DNNFNode>(NodeType::Decision, lo, hi);
-    node_table[key] = decision_node;
-
     if (dxz_mode) {
         num_of_zddNodes += 2;
     }else{
@@ -31,16 +23,113 @@ shared_ptr<DNNFNode> DanceDNNF::buildDecisionNode(int r, shared_ptr<DNNFNode> lo
     return decision_node;
 }
 
-shared_ptr<DNNFNode> DanceDNNF::buildDecomposableNode(vector<shared_ptr<DNNFNode>>& subDNNFs) {
-    auto decompose_node = make_shared<DNNFNode>(NodeType::Decomposed, -3);
-    decompose_node->children = subDNNFs;
-    return decompose_node;
+dnnf_id DanceDNNF::buildDecomposableNode(vector<dnnf_id>& subDNNFs) {
+    // 无解的分块使整个乘积为 FALSE，只有 TRUE 子电路时无需新建节点
+    vector<dnnf_id> children;
+    for (dnnf_id id : subDNNFs) {
+        if (id == DnnfStore::FALSE_ID) return DnnfStore::FALSE_ID;
+        if (id != DnnfStore::TRUE_ID) children.push_back(id);
+    }
+    if (children.empty()) return DnnfStore::TRUE_ID;
+    if (children.size() == 1) return children[0];
+
+    std::lock_guard<std::mutex> lock(tableMutex);
+    num_of_DNNFNodes += 1;
+    return dnnf.makeAnd(children.data(), children.size());
+}
+
+void DanceDNNF::exportCircuit() {
+    // 变量 i 对应输入矩阵的第 i 行
+    try {
+        if (!exportNnfPath.empty()) {
+            dnnf.writeNnf(exportNnfPath, rootDNNF, ROWS);
+            logger.logLine("Exported NNF: " + exportNnfPath);
+        }
+        if (!exportBinPath.empty()) {
+            dnnf.writeBinary(exportBinPath, rootDNNF, ROWS);
+            logger.logLine("Exported binary DNNF: " + exportBinPath);
+        }
+    } catch (const std::exception& e) {
+        logger.logLine("导出电路失败: " + std::string(e.what()));
+    }
+}
+
+void DanceDNNF::drawSamples() {
+    if (sampleCount == 0) return;
+    try {
+        std::ofstream file;
+        if (!samplePath.empty()) {
+            file.open(samplePath, std::ios::trunc);
+            if (!file.is_open()) throw std::runtime_error("无法写入文件: " + samplePath);
+        }
+        std::ostream& out = samplePath.empty() ? std::cout : file;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        DnnfSampler sampler(dnnf, rootDNNF, ROWS);
+        std::mt19937_64 rng(sampleSeed);
+        size_t drawn = sampler.sampleTo(out, sampleCount, rng);
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        std::ostringstream oss;
+        oss << "Samples: " << drawn << " in " << std::fixed << std::setprecision(3) << seconds << " s ("
+            << std::setprecision(0) << (seconds > 0 ? drawn / seconds : 0.0) << "/s)";
+        if (!samplePath.empty()) oss << " -> " << samplePath;
+        logger.logLine(oss.str());
+    } catch (const std::exception& e) {
+        logger.logLine("抽样失败: " + std::string(e.what()));
+    }
+}
+
+void DanceDNNF::enumerateSolutions() {
+    if (enumeratePath.empty()) return;
+    try {
+        std::ofstream file;
+        if (enumeratePath != "-") {
+            file.open(enumeratePath, std::ios::trunc);
+            if (!file.is_open()) throw std::runtime_error("无法写入文件: " + enumeratePath);
+        }
+        std::ostream& out = (enumeratePath == "-") ? std::cout : file;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        DnnfEnumerator enumerator(dnnf, rootDNNF);
+        uint64_t written = enumerator.writeTo(out, enumerateLimit);
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        std::ostringstream oss;
+        oss << "Enumerated: " << written << " in " << std::fixed << std::setprecision(3) << seconds << " s";
+        if (enumeratePath != "-") oss << " -> " << enumeratePath;
+        logger.logLine(oss.str());
+    } catch (const std::exception& e) {
+        logger.logLine("枚举失败: " + std::string(e.what()));
+    }
+}
+
+void DanceDNNF::evaluateSemiring() {
+    if (semiringName.empty()) return;
+    logger.logLine("Semiring " + semiringName + ": " + semiringValue);
+
+    // 半环值在搜索中已得到；选择性半环再沿电路回溯出取到该值的解
+    if (semiringName != MaxProductSemiring::name() && semiringName != MinSumSemiring::name()) return;
+    try {
+        std::vector<int> best;
+        evaluateCircuitByName(semiringName, dnnf, rootDNNF, searchWeights, &best);
+        if (!best.empty()) {
+            std::ostringstream rows;
+            for (size_t i = 0; i < best.size(); i++) rows << (i ? " " : "") << best[i] + 1;
+            logger.logLine("Best cover: " + rows.str());
+        }
+    } catch (const std::exception& e) {
+        logger.logLine("半环求值失败: " + std::string(e.what()));
+    }
 }
 
 // 串行处理每个子块，组合为 分解 节点
-DNNFResult DanceDNNF::serialSearch(vector<Block>& blocks, int parent_depth) {
+template <typename S>
+typename S::value_type DanceDNNF::serialSearch(vector<Block>& blocks, int parent_depth, dnnf_id& node) {
 
-    DNNFResult totalResult(1);
+    typename S::value_type totalResult = S::one();
+    vector<dnnf_id> subDNNFs(blocks.size(), DnnfStore::FALSE_ID);
+    node = DnnfStore::FALSE_ID;
     SubGraph* outerSubgraph = activeSubgraph_;
 
     std::vector<std::unique_ptr<splaytree::EulerTourTree>> stash;
@@ -58,7 +147,7 @@ DNNFResult DanceDNNF::serialSearch(vector<Block>& blocks, int parent_depth) {
         if (i >= stash.size() || !stash[i]) {
             std::cerr << "serialSearch: component " << i << " missing\n";
             restoreStash();
-            return DNNFResult(0);
+            return S::zero();
         }
 
         int anyV = stash[i]->getAnyVertex();
@@ -66,38 +155,46 @@ DNNFResult DanceDNNF::serialSearch(vector<Block>& blocks, int parent_depth) {
 
         components.push_back(std::move(stash[i]));
 
-        auto result = DXD(blocks[i], parent_depth + 1);
+        auto result = DXD<S>(blocks[i], parent_depth + 1, subDNNFs[i]);
 
         if (!components.empty()) {
             stash[i] = std::move(components[0]);
             components.clear();
         }
 
-        if (result.isZero()) {
+        // 子电路为 FALSE 当且仅当块无解，不依赖半环值能否判零（模计数可能恰为素数之积的倍数）
+        if (subDNNFs[i] == DnnfStore::FALSE_ID) {
             restoreStash();
-            return DNNFResult(0);
+            return S::zero();
         }
-        totalResult = totalResult * result;
+        totalResult = S::mul(totalResult, result);
     }
     restoreStash();
-    
+
+    node = buildDecomposableNode(subDNNFs);
     return totalResult;
 }
 
 // 开启多线程并行搜索，多个子线程继承父线程的检测结果，并求解其中一个分块
-DNNFResult DanceDNNF::parallelSearchUseOmp(vector<Block>& blocks, int parent_depth) {
+template <typename S>
+typename S::value_type DanceDNNF::parallelSearchUseOmp(vector<Block>& blocks, int parent_depth, dnnf_id& node) {
 
     const int n = blocks.size();
+    node = DnnfStore::FALSE_ID;
     std::atomic<bool> has_failure(false);
     std::atomic<bool> has_timeout(false);
 
     // 准备每个线程的初始树（在主线程中）
     std::vector<std::unique_ptr<splaytree::EulerTourTree>> extracted(n);
-    for (int i = 0; i < n; ++i)
+    // 交给子线程前先从主线程路由表注销，子线程再登记到各自的线程局部表
+    for (int i = 0; i < n; ++i) {
         extracted[i] = std::move(components[i]);
+        if (extracted[i]) extracted[i]->attachIndex(nullptr);
+    }
     components.clear();
 
-    std::vector<DNNFResult> results(n);
+    std::vector<typename S::value_type> results(n, S::one());
+    std::vector<dnnf_id> subDNNFs(n, DnnfStore::FALSE_ID);
     // 子线程搜索完毕后，将（可能被 Dec/Inc 修改过、但已回溯还原的）树写回此处
     std::vector<std::unique_ptr<splaytree::EulerTourTree>> returned(n);
     
@@ -114,9 +211,9 @@ DNNFResult DanceDNNF::parallelSearchUseOmp(vector<Block>& blocks, int parent_dep
             initThreadLocalState(blocks[i], std::move(extracted[i]));
 
             // === 执行搜索（自动使用线程局部数据） ===
-            auto result = DXD(blocks[i], parent_depth + 1);
+            auto result = DXD<S>(blocks[i], parent_depth + 1, subDNNFs[i]);
 
-            if (result.isZero()) {
+            if (subDNNFs[i] == DnnfStore::FALSE_ID) {
                 has_failure.store(true, std::memory_order_release);
             } else {
                 results[i] = result;
@@ -144,29 +241,34 @@ DNNFResult DanceDNNF::parallelSearchUseOmp(vector<Block>& blocks, int parent_dep
     }
 
     components.resize(n);
-    for (int i = 0; i < n; ++i)
+    for (int i = 0; i < n; ++i) {
         components[i] = std::move(returned[i]);
+        if (components[i]) components[i]->attachIndex(&vertexTrees);
+    }
     
     if (has_timeout.load()) {
         throw std::runtime_error("Time bound broken");
     }
     
     if (has_failure.load()) {
-        return DNNFResult(0);
+        return S::zero();
     }
     
-    // 计算总计数
-    DNNFResult totalResult(1);
+    // 各分块的值相乘
+    typename S::value_type totalResult = S::one();
     for (const auto& result : results) {
-        totalResult = totalResult * result;
+        totalResult = S::mul(totalResult, result);
     }
-    
+
+    node = buildDecomposableNode(subDNNFs);
     return totalResult;
 }
 
 
 // DXD IDXD
-DNNFResult DanceDNNF::DXD(Block& block, int depth) {
+template <typename S>
+typename S::value_type DanceDNNF::DXD(Block& block, int depth, dnnf_id& node) {
+    using V = typename S::value_type;
     
     // std::cout << "\n============================\n";
     // std::cout << "[Before] DXD called at depth " << depth << "\n";
@@ -177,16 +279,15 @@ DNNFResult DanceDNNF::DXD(Block& block, int depth) {
     }
     
     if(block.cols.empty()) {
-        return DNNFResult(1);
+        node = DnnfStore::TRUE_ID;
+        return S::one();
     } 
 
-    // 先查缓存
-    size_t state = hashBlockState(block.cols); 
+    // 先查缓存，命中时直接复用已构建的子电路
     {
-        std::shared_lock<std::shared_mutex> readLock(cacheMutex);
-        auto it = countCache.find(state);
-        if (it != countCache.end()) {
-            return it->second;
+        V cached;
+        if (cacheFor<S>().lookup(block.stateHash, block.cols, cached, node)) {
+            return cached;
         }
     }
 
@@ -204,72 +305,70 @@ DNNFResult DanceDNNF::DXD(Block& block, int depth) {
 
         int block_size = curBlock.size();
         if (block_size  > 1) {
-            num_of_DNNFNodes += block_size - 1; // 生成一个分解节点和block_size个子节点
             // std::cout << "Detected " << curBlock.size() << " independent blocks at depth " << depth << ".\n";
             // 检测到多个独立分块，则并行处理
             if(useETT && !single_thread_mode) turnOffGraphSync();
             // addConcurrentThread(block_size);
 
-            DNNFResult result;
+            V result;
             if (isParallelSearch) {
-                result = parallelSearchUseOmp(curBlock, depth);
+                result = parallelSearchUseOmp<S>(curBlock, depth, node);
             } else {
-                result = serialSearch(curBlock, depth);
+                result = serialSearch<S>(curBlock, depth, node);
             }
 
-            setCacheCount(state, result);
+            setCacheCount<S>(block, result, node);
             return result;
         } 
 
     }
 
-    ColumnHeader* choose = selectOptimalColumn(block.cols); 
-    // std::cout << "Chosen column: " << choose->col << " (size: " << choose->size << ")\n";
+    col_id choose = selectOptimalColumn(block); 
+    // std::cout << "Chosen column: " << choose << " (size: " << getColSize(choose) << ")\n";
 
-    if(choose->size <= 0) {
-        setCacheCount(state, DNNFResult(0));
-        return DNNFResult(0);
+    if(getColSize(choose) <= 0) {
+        node = DnnfStore::FALSE_ID;
+        setCacheCount<S>(block, S::zero(), node);
+        return S::zero();
     }
 
-    // 将choose列下的行节点作为Decision节点加入children
+    // choose 列下的行依次作为决策节点串成链：x = (row, lo = 前面各行组成的链, hi = 选该行后的子电路)
 
-    DNNFResult totalResult(0);
-    shared_ptr<DNNFNode> x = F;
+    V totalResult = S::zero();
+    dnnf_id x = DnnfStore::FALSE_ID;
 
     set<int> deleted_rows;
-    coverInBlock(choose->col, block, deleted_rows);
+    coverInBlock(choose, block, deleted_rows);
     DecUpdateCC(deleted_rows);
 
-    Node* curC = choose->down;
-    while(curC != choose) {
+    const DlxArena::index_t colNode = choose;
+    for (DlxArena::index_t curC = dlx.D(colNode); curC != colNode; curC = dlx.D(curC)) {
         
-        Node* curR = curC->right;
         set<int> deleted_rows_;
 
-        while (curR != curC) {
-            coverInBlock(curR->col, block, deleted_rows_);
-            curR = curR->right;
+        for (DlxArena::index_t curR = dlx.R(curC); curR != curC; curR = dlx.R(curR)) {
+            coverInBlock(dlx.C(curR), block, deleted_rows_);
         }
         DecUpdateCC(deleted_rows_);
  
-        auto result = DXD(block, depth + 1);
+        dnnf_id child = DnnfStore::FALSE_ID;
+        auto result = DXD<S>(block, depth + 1, child);
 
-        if(!result.isZero()) {
-            auto y = make_shared<DNNFNode>(NodeType::Decision, curR->row, result.count);
-            buildDecisionNode(curR->row, x, y);
-            totalResult = totalResult + result;
+        if(child != DnnfStore::FALSE_ID) {
+            x = buildDecisionNode(dlx.ROW(curC), x, child);
+            if constexpr (S::weighted) {
+                totalResult = S::add(totalResult, S::mul(rowWeight<S>(searchWeights, dlx.ROW(curC)), result));
+            } else {
+                totalResult = S::add(totalResult, result);
+            }
         }
         
-        curR = curC->left;
-        while (curR != curC) {
-            uncoverInBlock(curR->col, block);
-            curR = curR->left;
+        for (DlxArena::index_t curR = dlx.L(curC); curR != curC; curR = dlx.L(curR)) {
+            uncoverInBlock(dlx.C(curR), block);
         }
         IncUpdateCC(deleted_rows_);
-
-        curC = curC->down;
     }
-    uncoverInBlock(choose->col, block);
+    uncoverInBlock(choose, block);
     IncUpdateCC(deleted_rows);
 
     // std::cout << "\n============================\n";
@@ -277,11 +376,46 @@ DNNFResult DanceDNNF::DXD(Block& block, int depth) {
     // printComponents();
 
     // 插入缓存
-    setCacheCount(state, totalResult);
+    node = x;
+    setCacheCount<S>(block, totalResult, node);
     return totalResult;
 }
 
 
+template <typename S>
+typename S::value_type DanceDNNF::searchIn() {
+    auto value = DXD<S>(InitBlock, 1, rootDNNF);
+    cacheSummary = cacheFor<S>().summary();
+    cacheMemory = cacheFor<S>().memoryBytes();
+    return value;
+}
+
+std::string DanceDNNF::searchRoot() {
+    semiringValue.clear();
+    if (!semiringName.empty() && semiringName != CountSemiring::name()) {
+        if (semiringName == ModCountSemiring::name()) {
+            semiringValue = searchIn<ModCountSemiring>().toString();
+        } else if (semiringName == LogCountSemiring::name()) {
+            semiringValue = searchIn<LogCountSemiring>().toString();
+        } else if (semiringName == WeightedSumSemiring::name()) {
+            semiringValue = WeightedSumSemiring::toString(searchIn<WeightedSumSemiring>());
+        } else if (semiringName == MaxProductSemiring::name()) {
+            semiringValue = MaxProductSemiring::toString(searchIn<MaxProductSemiring>());
+        } else if (semiringName == MinSumSemiring::name()) {
+            semiringValue = MinSumSemiring::toString(searchIn<MinSumSemiring>());
+        } else {
+            throw std::invalid_argument("Unknown semiring: " + semiringName);
+        }
+        // 解数由电路线性求值得到，不必再搜索一次
+        return evaluateCircuit<CountSemiring>(dnnf, rootDNNF, searchWeights).toString();
+    }
+
+    std::string count = countMode == CountMode::Modular ? searchIn<ModCountSemiring>().toString()
+                                                         : searchIn<CountSemiring>().toString();
+    if (semiringName == CountSemiring::name()) semiringValue = count;
+    return count;
+}
+
 void DanceDNNF::startDXD() {
 
     if(!controlOUTPUT)  logger.logLine("开始单线程DXD搜索...");
@@ -297,7 +431,7 @@ void DanceDNNF::startDXD() {
         timer.reset();
         timer.markStartTime();
         auto start = std::chrono::high_resolution_clock::now();
-        auto ResSols = DXD(InitBlock, 1);  
+        auto ResSols = searchRoot();  
         auto end = std::chrono::high_resolution_clock::now();
         timer.markStopTime();
 
@@ -305,8 +439,12 @@ void DanceDNNF::startDXD() {
         logger.logLine("Time: " + std::to_string(searchTime) + " s");
         timeout = false;
 
-        solutionCount = ResSols.toString();
+        solutionCount = ResSols;
         logger.logLine("Solutions: " + solutionCount);
+        if (countMode == CountMode::Modular) {
+            logger.logLine("Count mode: mod " + std::to_string(ModCount::rep_type::size()) + " x 61-bit primes, CRT exact below 2^" +
+                           std::to_string(ModCount::rep_type::BOUND_BITS));
+        }
     
         if(!controlOUTPUT) logger.logLine("Max Blocks: " + std::to_string(MAX_B_COUNT));
 
@@ -314,7 +452,13 @@ void DanceDNNF::startDXD() {
             logger.logLine("ZDD Size: " + std::to_string(num_of_zddNodes));
         } else {
             logger.logLine("DNNF Size: " + std::to_string(num_of_DNNFNodes));
+            logger.logLine(cacheSummary);
+            logger.logLine(dnnf.summary());
         }
+        exportCircuit();
+        drawSamples();
+        enumerateSolutions();
+        evaluateSemiring();
 
         return;
     } catch (std::runtime_error &e) {
@@ -337,7 +481,7 @@ void DanceDNNF::startMultiThreadDXD() {
         timer.reset();
         timer.markStartTime();
         auto start = std::chrono::high_resolution_clock::now();
-        auto ResSols = DXD(InitBlock, 1);  // 多线程DXD搜索
+        auto ResSols = searchRoot();  // 多线程DXD搜索
         auto end = std::chrono::high_resolution_clock::now();
         timer.markStopTime();
    
@@ -345,15 +489,25 @@ void DanceDNNF::startMultiThreadDXD() {
         logger.logLine("Time: " + std::to_string(searchTime) + " s");
         timeout = false;
 
-        solutionCount = ResSols.toString();
+        solutionCount = ResSols;
         logger.logLine("Solutions: " + solutionCount);
+        if (countMode == CountMode::Modular) {
+            logger.logLine("Count mode: mod " + std::to_string(ModCount::rep_type::size()) + " x 61-bit primes, CRT exact below 2^" +
+                           std::to_string(ModCount::rep_type::BOUND_BITS));
+        }
     
         logger.logLine("Max Blocks: " + std::to_string(MAX_B_COUNT));
         if(dxz_mode) {
             logger.logLine("ZDD Size: " + std::to_string(num_of_zddNodes));
         } else {
             logger.logLine("DNNF Size: " + std::to_string(num_of_DNNFNodes));
+            logger.logLine(cacheSummary);
+            logger.logLine(dnnf.summary());
         }
+        exportCircuit();
+        drawSamples();
+        enumerateSolutions();
+        evaluateSemiring();
         return;
     } catch (std::runtime_error &e) {
         timeout = true;
@@ -450,44 +604,38 @@ DNNFResult DanceDNNF::MDLX(vector<int>& sols, Block& block) {
         } 
     }
 
-    ColumnHeader* choose = selectColumnHeuristic(block.cols);
-    if( !choose || choose->size <= 0 ) {
+    col_id choose = selectOptimalColumn(block);
+    if( choose < 0 || getColSize(choose) <= 0 ) {
         return DNNFResult(0);  
     }
 
     DNNFResult totalResult = DNNFResult(0);
 
     set<int> deleted_rows;
-    coverInBlock( choose->col, block, deleted_rows );
-    Node* curC = choose->down;  
+    coverInBlock( choose, block, deleted_rows );
 
-    while( curC != choose )  
+    const DlxArena::index_t colNode = choose;
+    for( DlxArena::index_t curC = dlx.D(colNode); curC != colNode; curC = dlx.D(curC) )  
     {  
-         
-        Node* curR = curC->right;  
-        while( curR != curC )  
+        for( DlxArena::index_t curR = dlx.R(curC); curR != curC; curR = dlx.R(curR) )  
         {  
-            coverInBlock( curR->col, block, deleted_rows );  
-            curR = curR->right;  
+            coverInBlock( dlx.C(curR), block, deleted_rows );  
         }  
 
-        sols.push_back(curC->row + 1); 
+        sols.push_back(dlx.ROW(curC) + 1); 
         // 递归搜索
         auto result = MDLX(sols, block);
         if (!result.isZero()) {
-            totalResult = totalResult + result;
+            totalResult += result;
         }
        
         sols.pop_back();  // 回溯，移除当前行
-        curR = curC->left;  
-        while( curR != curC )  
+        for( DlxArena::index_t curR = dlx.L(curC); curR != curC; curR = dlx.L(curR) )  
         {  
-            uncoverInBlock( curR->col, block );  
-            curR = curR->left;  
+            uncoverInBlock( dlx.C(curR), block );  
         }  
-        curC = curC->down;  
     }  
-    uncoverInBlock( choose->col, block );  
+    uncoverInBlock( choose, block );  
     return totalResult; 
 }
 
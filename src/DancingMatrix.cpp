@@ -1,36 +1,14 @@
 #include "../include/DancingMatrix.h"
 #include "DynamicGraph.cpp"
 thread_local std::unique_ptr<DancingMatrix::ThreadLocalState> DancingMatrix::tlsState = nullptr;
+thread_local std::vector<splaytree::EulerTourTree*> DancingMatrix::tlsVertexTrees;
 
 //构造函数
 DancingMatrix::DancingMatrix( int rows, int cols, int** matrix, bool verbose )  
     : ROWS(rows), COLS(cols), enableGraphSync(verbose) {
     EXIST_ROWS = rows;  
-    ColIndex = std::make_unique<ColumnHeader[]>(cols + 1);  
-    RowIndex = std::make_unique<RowNode[]>(rows);  
     // if (verbose) graph = make_unique<ConnectedGraph>(rows, cols);
-
-    root = &ColIndex[0];  
-    ColIndex[0].left = &ColIndex[COLS];  
-    ColIndex[0].right = &ColIndex[1];  
-    ColIndex[COLS].right = &ColIndex[0];  
-    ColIndex[COLS].left = &ColIndex[COLS-1];  
-
-    for( int i = 1; i < cols; i++ )  
-    {  
-        ColIndex[i].left = &ColIndex[i-1];  
-        ColIndex[i].right = &ColIndex[i+1];  
-    }  
-
-    for ( int i = 0; i <= cols; i++ )  
-    {  
-        ColIndex[i].up = &ColIndex[i];  
-        ColIndex[i].down = &ColIndex[i];  
-        ColIndex[i].col = i;  
-    }  
-    ColIndex[0].down = &RowIndex[0];  
-    
-    dataNodes.reserve(rows * cols / 2);
+    initHeaders(rows, cols, static_cast<size_t>(rows) * cols / 2);
 
     // graph = std::make_shared<ConnectedGraph>(ROWS, COLS);
     for( int i = 0; i < rows; i++ ){
@@ -44,31 +22,84 @@ DancingMatrix::DancingMatrix( int rows, int cols, int** matrix, bool verbose )
     }
 
     InitBlock = Block(rowsSet, colsSet);
+    sealBlock(InitBlock);
     // if(verbose) graph = make_unique<ConnectedGraph>(*this);
     std::cout<< "初始化舞蹈链完成." << endl;
 }
 
-// 从文件构造舞蹈链矩阵
-DancingMatrix::DancingMatrix( const string& file_path, int from, bool useIg , bool useETT  ) 
-    : useIG(useIg), useETT(useETT)
+// 从文件构造舞蹈链矩阵，文本实例与二进制 CSR 实例按文件头自动区分
+DancingMatrix::DancingMatrix( const string& file_path, int from, bool useIg , bool useETT, ConnectivityGraph conn ) 
+    : useIG(useIg), useETT(useETT), connectivity(conn)
 {
-    ifstream file(file_path);
-    if (!file.is_open()) {
-        cerr << "无法打开文件: " << file_path << endl;
-        throw runtime_error("无法打开文件");
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    MappedFile file(file_path);
+    double megaBytes = file.size() / (1024.0 * 1024.0);
+    std::ostringstream loadInfo;
+    loadInfo << std::fixed << std::setprecision(2);
+
+    if (InstanceLoader::isBinary(file.data(), file.size())) {
+        // 二进制实例直接在映射内存上建立视图，无需解析
+        CsrView csr = InstanceLoader::viewBinary(file.data(), file.size());
+        double loadSeconds = std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - loadStart).count();
+        loadInfo << "载入二进制实例: " << megaBytes << " MB, " << loadSeconds * 1000.0 << " ms";
+        cout << loadInfo.str() << endl;
+
+        buildFromCsr(csr);
+    } else {
+        // 原地解析为 CSR，避免逐行 getline + istringstream
+        SparseInstance inst = InstanceLoader::parseBuffer(file.data(), file.data() + file.size(), from);
+        double parseSeconds = std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - loadStart).count();
+        loadInfo << "解析实例: " << megaBytes << " MB, " << parseSeconds * 1000.0 << " ms, "
+                 << (parseSeconds > 0 ? megaBytes / parseSeconds : 0.0) << " MB/s";
+        cout << loadInfo.str() << endl;
+
+        buildFromCsr(inst.view());
     }
 
-    string line;
-    getline(file, line);  // 读取第一行 
+    InitBlock = Block(rowsSet, colsSet);
+    sealBlock(InitBlock);
 
-    int rows, cols;
-    if( from == 1 ) {
-        PreProccess::extractNM( line, cols, rows );
-        getline(file, line); 
-    } else {
-        istringstream iss(line);
-        iss >> cols >> rows;
+    if(useETT){
+        // detector = make_unique<ComponentDetector>(ROWS, COLS); 
+        // detector->Initialize(col_to_rows);
+        int graphVertices = ROWS + (connectivity == ConnectivityGraph::Bipartite ? COLS : 0);
+        graph = make_unique<Graph>(graphVertices);
+        initialize();
+        
+        cout << "ETT initialization complete." << endl;
+        cout << "连通图: " << connectivityGraphName(connectivity) << ", 顶点 " << graphVertices
+             << ", 边 " << graph->numEdges() << endl;
+    }
+
+    if (useIg) {
+        incrementalGraph = make_unique<IncrementalConnectedGraph>(ROWS);
+        incrementalGraph->initialize(*this);
     }
+}
+
+DancingMatrix::~DancingMatrix() = default;
+
+void DancingMatrix::initHeaders(int rows, int cols, size_t nnz) {
+    colSize = std::make_unique<int[]>(cols + 1);
+    rowSize = std::make_unique<int[]>(rows);
+    rowHead = std::make_unique<DlxArena::index_t[]>(rows);  // 0 表示空行
+
+    // 固定种子，保证多次运行的缓存键一致
+    colKey = std::make_unique<uint64_t[]>(cols + 1);
+    std::mt19937_64 keyGen(0x5DEECE66DULL);
+    for (int i = 0; i <= cols; i++) {
+        colKey[i] = keyGen();
+    }
+
+    // 根节点与列头占据下标 0..cols，列头下标即列号
+    DlxBuilder::initHeaders(dlx, cols, nnz);
+}
+
+void DancingMatrix::buildFromCsr(const CsrView& csr) {
+    int rows = csr.rows;
+    int cols = csr.cols;
 
     ROWS = rows;
     COLS = cols;
@@ -78,87 +109,40 @@ DancingMatrix::DancingMatrix( const string& file_path, int from, bool useIg , bo
         throw runtime_error("time out");
     }
 
-    // cout << "处理矩阵维度: " << rows << " 行, " << cols << " 列." << endl;
-    ColIndex = std::make_unique<ColumnHeader[]>(cols + 1);  
-    RowIndex = std::make_unique<RowNode[]>(rows);  
-    root = &ColIndex[0];  
-
-    ColIndex[0].left = &ColIndex[COLS];  
-    ColIndex[0].right = &ColIndex[1];  
-    ColIndex[COLS].right = &ColIndex[0];  
-    ColIndex[COLS].left = &ColIndex[COLS-1];  
-
-    for( int i = 1; i < cols; i++ )  
-    {  
-        ColIndex[i].left = &ColIndex[i-1];  
-        ColIndex[i].right = &ColIndex[i+1];  
-    }  
+    // 批量建立舞蹈链，避免逐个有序插入时对长列的线性扫描
+    initHeaders(rows, cols, csr.nnz);
+    DlxBuilder::linkBulk(dlx, csr, colSize.get(), rowSize.get(), rowHead.get());
 
-    for ( int i = 0; i <= cols; i++ )  
-    {  
-        ColIndex[i].up = &ColIndex[i];  
-        ColIndex[i].down = &ColIndex[i];  
-        ColIndex[i].col = i;  
-    }  
-    ColIndex[0].down = &RowIndex[0]; 
-
-    dataNodes.reserve(rows * cols / 2);
-    int currentRow = 0;
-    while (getline(file, line)) {
-        if (line.empty()) continue; // 跳过空行
-        istringstream iss(line);
-
-        string token;
-        if (from == 1 || from == 3) {
-            iss >> token;
-        } else if (from == 2) {
-            iss >> token;
-            iss >> token;
-        }
-
-        int currentCol; 
-        // std::vector<int> rowCols;
-        while(iss >> currentCol) {
-            if (currentCol < 1 || currentCol > cols) {
-                cerr << "无效的列索引: " << currentCol << " 在行 " << currentRow + 1 << endl;
-                exit(1);
-            }
-            insert(currentRow, currentCol); // 插入节点
-            col_to_rows[currentCol].push_back(currentRow);
+    for (int currentRow = 0; currentRow < rows; currentRow++) {
+        for (uint32_t k = csr.rowOffsets[currentRow]; k < csr.rowOffsets[currentRow + 1]; k++) {
+            int currentCol = csr.colIndices[k];
             row_to_cols[currentRow].insert(currentCol);
             ONE_COUNT++; // 统计矩阵中1的个数
             rowsSet.insert(currentRow);
             colsSet.insert(currentCol); 
-            // rowCols.push_back(currentCol);
         }
-
-        currentRow++;
-        
-        if (currentRow >= rows) break; // 防止超过预期行数
     }
 
-    InitBlock = Block(rowsSet, colsSet);
-
-    if(useETT){
-        // detector = make_unique<ComponentDetector>(ROWS, COLS); 
-        // detector->Initialize(col_to_rows);
-        graph = make_unique<Graph>(ROWS);
-        initialize();
-        
-        cout << "ETT initialization complete." << endl;
-    }
-
-    if (useIg) {
-        incrementalGraph = make_unique<IncrementalConnectedGraph>(rows);
-        incrementalGraph->initialize(*this);
+    // 列 -> 行索引：二进制实例可直接使用预先计算的索引
+    if (csr.hasColumnIndex()) {
+        for (int c = 1; c <= cols; c++) {
+            if (csr.colOffsets[c] == csr.colOffsets[c + 1]) continue;
+            col_to_rows[c].assign(csr.colRows + csr.colOffsets[c], csr.colRows + csr.colOffsets[c + 1]);
+        }
+    } else {
+        for (int c = 1; c <= cols; c++) {
+            if (colSize[c] > 0) col_to_rows[c].reserve(colSize[c]);
+        }
+        for (int currentRow = 0; currentRow < rows; currentRow++) {
+            for (uint32_t k = csr.rowOffsets[currentRow]; k < csr.rowOffsets[currentRow + 1]; k++) {
+                col_to_rows[csr.colIndices[k]].push_back(currentRow);
+            }
+        }
     }
-
-    file.close();
 }
 
-DancingMatrix::~DancingMatrix() = default;
-
 void DancingMatrix::initialize() {
+    vertexTrees.assign(static_cast<size_t>(graph->numVertices()), nullptr);
     buildGraphFromMatrix();
     buildSpanningForest();
 }
@@ -183,6 +167,7 @@ void DancingMatrix::initThreadLocalState(const Block& block, std::unique_ptr<spl
     
     int anyV = tree->getAnyVertex();
 
+    tree->attachIndex(&tlsVertexTrees);
     tlsState->components.push_back(std::move(tree));
     
     if (anyV >= 0) {
@@ -210,9 +195,6 @@ std::unique_ptr<splaytree::EulerTourTree> DancingMatrix::deepCopyTree(
     // 拷贝顶点集合
     newTree->setVertices(original->getVertices());
     
-    // 拷贝非树边集合
-    newTree->setNonTreeEdges(original->getNonTreeEdges());
-    
     // 收集原树的所有节点
     std::vector<splaytree::Node*> originalNodes;
     original->collectNodes(original->getRoot(), originalNodes);
@@ -239,13 +221,16 @@ std::unique_ptr<splaytree::EulerTourTree> DancingMatrix::deepCopyTree(
     
     // 重建平衡的 Splay 树
     newTree->root = newTree->buildFromNodes(newNodes, 0, newNodes.size() - 1);
+
+    // 拷贝非树边集合（顶点节点建好后才能记录非树边计数）
+    newTree->setNonTreeEdges(original->getNonTreeEdges());
     
     return newTree;
 }
 
 std::unique_ptr<Graph> DancingMatrix::deepCopyGraph(splaytree::EulerTourTree* tree) {
     
-    auto newGraph = std::make_unique<Graph>(ROWS);
+    auto newGraph = std::make_unique<Graph>(graph->numVertices());
     if (!tree) return newGraph;
     
     const auto& nonTreeEdges = tree->getNonTreeEdges();
@@ -261,6 +246,7 @@ std::unique_ptr<Graph> DancingMatrix::deepCopyGraph(splaytree::EulerTourTree* tr
             newGraph->addEdge(node->u, node->v);
         }
     }
+    newGraph->finalize();
     
     return newGraph;
 }
@@ -268,6 +254,17 @@ std::unique_ptr<Graph> DancingMatrix::deepCopyGraph(splaytree::EulerTourTree* tr
 // 将矩阵的行映射为无向图的顶点，构建邻接表存储所有边
 void DancingMatrix::buildGraphFromMatrix() {
 
+    if (connectivity == ConnectivityGraph::Bipartite) {
+        // 每个非零元一条行-列边；没有行的列不会连到任何行，不进入生成森林
+        colLiveRows.assign(static_cast<size_t>(COLS) + 1, 0);
+        for (const auto& [col, rows] : col_to_rows) {
+            colLiveRows[col] = static_cast<int>(rows.size());
+            for (int r : rows) graph->addEdge(r, columnVertex(col));
+        }
+        graph->finalize();
+        return;
+    }
+
     std::vector<std::pair<int, int>> temp_edges;
 
     for (const auto& [col, rows] : col_to_rows) {
@@ -295,6 +292,7 @@ void DancingMatrix::buildGraphFromMatrix() {
     for (const auto& edge : temp_edges) {
         graph->addEdge(edge.first, edge.second);
     }
+    graph->finalize();
 
     // graph->printGraph();
 }
@@ -411,6 +409,7 @@ void DancingMatrix::buildSpanningForest() {
                 //     vertexToComponent[vertex] = tree.get();
                 // }
 
+                tree->attachIndex(&this->vertexTrees);
                 components.push_back(std::move(tree)); // 保存生成的树
                 break;
             }
@@ -421,8 +420,12 @@ void DancingMatrix::buildSpanningForest() {
 }
 
 splaytree::EulerTourTree* DancingMatrix::findEulerTourTree(int v) {
+    if (routeByIndex) {
+        auto& index = getVertexTrees();
+        return (v >= 0 && static_cast<size_t>(v) < index.size()) ? index[v] : nullptr;
+    }
+
     auto& comps = getComponents();
-    
     for (auto& tree : comps) {
         if (tree && tree->containsVertex(v)) {
             return tree.get();
@@ -433,7 +436,7 @@ splaytree::EulerTourTree* DancingMatrix::findEulerTourTree(int v) {
 
 void DancingMatrix::processBoundaryVertex(int v, splaytree::EulerTourTree* tree, SubGraph* g){
     // 处理所有相邻边(包含非树边)
-    std::vector<int> neighbors = g->neighbors(v);
+    VertexRange neighbors = g->neighbors(v);
     
     // 边界顶点：删除所有非树边，无需寻找替代边
     // std::cout << "Removing boundary vertex " << v << "\n";
@@ -488,14 +491,24 @@ void DancingMatrix::DecUpdateCC(const std::set<int>& deletedVertices) {
         return;
     }
 
-    std::vector<int> boundaryVertices;
-    std::vector<int> otherVertices;
+    // 二分图模式下，失去全部活跃行的列顶点与这些行一起删除。
+    // colLiveRows 须在下面的提前返回之前更新：IncUpdateCC 恢复同一批行时总会加回，两边条件一致才不会漂移。
+    // 临时数组按线程复用，回溯中反复调用时不再申请内存
+    thread_local std::vector<int> vertices;
+    if (connectivity == ConnectivityGraph::Bipartite) withColumnVertices(deletedVertices, false, vertices);
+    else vertices.assign(deletedVertices.begin(), deletedVertices.end());
+
+    thread_local std::vector<int> boundaryVertices;
+    thread_local std::vector<int> otherVertices;
+    boundaryVertices.clear();
+    otherVertices.clear();
 
     // 当前连通分量
+    if (comps.empty()) return;
     splaytree::EulerTourTree* current_tree = comps[0].get();
     if (!current_tree) return;
 
-    for (int v : deletedVertices) {
+    for (int v : vertices) {
         int treeEdgeCount = current_tree->getVertexDegree(v);
 
         if (treeEdgeCount == 1) {
@@ -518,7 +531,7 @@ void DancingMatrix::DecUpdateCC(const std::set<int>& deletedVertices) {
         if (!tree) continue; 
 
         // 处理所有相邻边
-        std::vector<int> neighbors = g->neighbors(v);
+        VertexRange neighbors = g->neighbors(v);
         int currentDegree = tree->getVertexDegree(v);
 
         if (currentDegree == 0) {
@@ -538,8 +551,10 @@ void DancingMatrix::DecUpdateCC(const std::set<int>& deletedVertices) {
         // std::cout << "Removing non-boundary vertex " << v << "\n";
         
         // 收集树边邻居和非树边邻居
-        std::vector<int> treeNeighbors;
-        std::vector<int> nonTreeNeighbors;
+        thread_local std::vector<int> treeNeighbors;
+        thread_local std::vector<int> nonTreeNeighbors;
+        treeNeighbors.clear();
+        nonTreeNeighbors.clear();
         
         for (int u : neighbors) {
             if (tree->isTreeEdge(v, u)) {
@@ -595,13 +610,7 @@ void DancingMatrix::DecUpdateCC(const std::set<int>& deletedVertices) {
     }
     
     // 更新连通分量
-    comps.erase(
-        std::remove_if(comps.begin(), comps.end(),
-            [](const std::unique_ptr<splaytree::EulerTourTree>& t) { 
-                return t->isEmpty(); 
-            }),
-        comps.end()
-    );
+    recycleEmptyTrees();
 
 }
 
@@ -621,22 +630,29 @@ void DancingMatrix::IncUpdateCC(const std::set<int>& restoredVertices) {
         return;
     }
 
-    std::unordered_set<int> restoredSet(restoredVertices.begin(), restoredVertices.end());
+    // 二分图模式下，重新获得活跃行的列顶点与这些行一起恢复
+    thread_local std::vector<int> vertices;
+    if (connectivity == ConnectivityGraph::Bipartite) withColumnVertices(restoredVertices, true, vertices);
+    else vertices.assign(restoredVertices.begin(), restoredVertices.end());
 
-    for (int v : restoredVertices) {
-        auto newTree = std::make_unique<splaytree::EulerTourTree>(nextTreeId++);
+    auto& index = getVertexTrees();
+
+    // 每个恢复的顶点先单独成树，随后大多被合并掉，树对象从回收的空树中取用
+    for (int v : vertices) {
+        auto newTree = splaytree::EulerTourTree::acquire(nextTreeId++);
+        newTree->attachIndex(&index);
         newTree->addVertex(v);
         comps.push_back(std::move(newTree));
     }
     
-    for (int v : restoredVertices) {
-        std::vector<int> neighbors = g->getAllNeighbors(v); 
+    for (int v : vertices) {
+        VertexRange neighbors = g->getAllNeighbors(v);
 
         for (int u : neighbors) {
             splaytree::EulerTourTree* treeU = findEulerTourTree(u);
             if (!treeU) continue;
 
-            if (restoredSet.count(u) && v > u) continue;
+            if (v > u && std::binary_search(vertices.begin(), vertices.end(), u)) continue;
 
             if (!g->hasEdge(v, u)) {
                 g->restoreEdge(v, u);
@@ -654,11 +670,21 @@ void DancingMatrix::IncUpdateCC(const std::set<int>& restoredVertices) {
         }
     }
     
-    comps.erase(
-        std::remove_if(comps.begin(), comps.end(),
-            [](const std::unique_ptr<splaytree::EulerTourTree>& t) { return t->isEmpty(); }),
-        comps.end()
-    );
+    recycleEmptyTrees();
+}
+
+void DancingMatrix::recycleEmptyTrees() {
+    auto& comps = getComponents();
+    size_t kept = 0;
+    for (size_t i = 0; i < comps.size(); i++) {
+        if (comps[i]->isEmpty()) {
+            splaytree::EulerTourTree::recycle(std::move(comps[i]));
+        } else {
+            if (kept != i) comps[kept] = std::move(comps[i]);
+            kept++;
+        }
+    }
+    comps.resize(kept);
 }
 
 std::vector<std::unordered_set<int>> DancingMatrix::getConnectedComponents() const {
@@ -750,28 +776,68 @@ void DancingMatrix::testCutEdge(int u, int v) {
     tree1Ptr->printEulerTour();
 }
 
-vector<Block> DancingMatrix::getComponentsByIG(const set<int> rows) {
-    return incrementalGraph->computeComponentsInRows(rows);
+vector<Block> DancingMatrix::getComponentsByIG(const SparseSet& rows) {
+    vector<Block> blocks = incrementalGraph->computeComponentsInRows(rows);
+    for (Block& block : blocks) sealBlock(block);
+    return blocks;
     // return findComponents(rows);
 };
 
+ConnectivityGraph parseConnectivityGraph(const std::string& name) {
+    if (name == "clique") return ConnectivityGraph::Clique;
+    if (name == "bipartite") return ConnectivityGraph::Bipartite;
+    throw std::invalid_argument("Unknown connectivity graph: " + name);
+}
+
+std::string connectivityGraphName(ConnectivityGraph graph) {
+    return graph == ConnectivityGraph::Bipartite ? "bipartite" : "clique";
+}
+
+void DancingMatrix::withColumnVertices(const std::set<int>& rows, bool restoring, std::vector<int>& out) {
+    out.assign(rows.begin(), rows.end());
+    for (int r : rows) {
+        auto it = row_to_cols.find(r);
+        if (it == row_to_cols.end()) continue;
+        for (int c : it->second) {
+            int& live = colLiveRows[c];
+            if (restoring ? live++ == 0 : --live == 0) out.push_back(columnVertex(c));
+        }
+    }
+    // 列顶点编号都大于行，只需给新加入的列排序
+    std::sort(out.begin() + rows.size(), out.end());
+}
+
 vector<Block> DancingMatrix::getComponentsByETT() {
     // 使用当前线程的 components
     auto& comps = getComponents();
 
     vector<Block> blocks;
+    blocks.reserve(comps.size());
+
+    // 用标记数组收集分量的列，避免 set 插入
+    vector<char> seen(static_cast<size_t>(COLS) + 1, 0);
+    vector<int> block_cols;
     for (const auto& tree : comps) {
-        unordered_set<int> comp_rows = tree->getVertices();
-        set<int> block_rows(comp_rows.begin(), comp_rows.end());
-        set<int> block_cols;
+        // 二分图模式下树中还有列顶点（编号不小于 ROWS），块只取其中的行
+        vector<int> block_rows;
+        block_rows.reserve(tree->vertices.size());
+        for (int v : tree->vertices) {
+            if (v < ROWS) block_rows.push_back(v);
+        }
 
+        block_cols.clear();
         for (int r : block_rows) {
             for (int c : row_to_cols[r]) {
-                block_cols.insert(c);
+                if (!seen[c]) {
+                    seen[c] = 1;
+                    block_cols.push_back(c);
+                }
             }
         }
+        for (int c : block_cols) seen[c] = 0;
 
         blocks.emplace_back(block_rows, block_cols);
+        sealBlock(blocks.back());
     }
     return blocks;
 };
@@ -808,43 +874,7 @@ void DancingMatrix::testSplay(int v) {
 //插入元素到双向十字链表中
 void DancingMatrix::insert( int r, int c )  
 {  
-    ColIndex[c].size++;  
-    RowIndex[r].size++;
-    // ColIndex[c].rows.insert(r);
-    // RowIndex[r].cols.insert(c);
-    auto newNode = std::make_unique<Node>(r, c);  
-    Node* newNodePtr = newNode.get();
-
-    Node* cur = &ColIndex[c];  
-    while( cur->down != &ColIndex[c] && cur->down->row < r )  
-        cur = cur->down;  
-
-    newNodePtr->down = cur->down;  
-    newNodePtr->up = cur;  
-    cur->down->up = newNodePtr;  
-    cur->down = newNodePtr;  
-    if( RowIndex[r].right == nullptr )  
-    {  
-        RowIndex[r].right = newNodePtr; 
-        newNodePtr->row_first_node = true;
-        newNode->left = newNodePtr;  
-        newNode->right = newNodePtr;  
-    }  
-    else  
-    {  
-        Node* rowHead = RowIndex[r].right;  
-        cur = rowHead;  
-
-        while( cur->right != rowHead && cur->right->col < c )  
-            cur = cur->right;  
-
-        newNodePtr->right = cur->right;  
-        newNodePtr->left = cur;  
-        cur->right->left = newNodePtr;  
-        cur->right = newNodePtr;  
-    }  
-
-    dataNodes.push_back(std::move(newNode));
+    DlxBuilder::insertSorted(dlx, colSize.get(), rowSize.get(), rowHead.get(), r, c);
 }
 
 string DancingMatrix::encodeBlockState(const unordered_set<int>& cols){
@@ -855,21 +885,20 @@ string DancingMatrix::encodeBlockState(const unordered_set<int>& cols){
     return state;
 }
 
-size_t DancingMatrix::hashBlockState(const set<int>& cols) {
-    size_t hash = 0;
+size_t DancingMatrix::hashBlockState(const SparseSet& cols) {
+    // Zobrist 哈希：各列随机键的异或，与遍历顺序无关
+    uint64_t hash = 0;
     for(int col : cols) {
-        hash ^= std::hash<int>()(col) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        hash ^= colKey[col];
     }
-    return hash;
+    return static_cast<size_t>(hash);
 }
 
 //获取当前列的状态
 size_t DancingMatrix::getColumnState() const {
     size_t hash = 0;
-    ColumnHeader* cur = (ColumnHeader*)root->right;
-    while (cur != root) {
-        hash ^= std::hash<int>()(cur->col) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-        cur = (ColumnHeader*)cur->right;
+    for (DlxArena::index_t cur = dlx.R(ROOT); cur != ROOT; cur = dlx.R(cur)) {
+        hash ^= std::hash<int>()(dlx.C(cur)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
     }
     return hash;
 }
@@ -877,19 +906,13 @@ size_t DancingMatrix::getColumnState() const {
 // 创建当前状态的签名
 Signature DancingMatrix::getColumnSignature() const {
     Signature sig;
-    sig.covered.resize(COLS + 1, false);
+    sig.covered.resize(COLS + 1, true);
     
-    // 标记已覆盖的列
-    for (int j = 1; j <= COLS; j++) {
-        bool found = false;
-        for (int k = root->right->col; k != 0; k = ColIndex[k].right->col) {
-            if (k == j) {
-                found = true;
-                break;
-            }
-        }
-        sig.covered[j] = !found;
+    // 仍在列头链表中的列未被覆盖
+    for (DlxArena::index_t k = dlx.R(ROOT); k != ROOT; k = dlx.R(k)) {
+        sig.covered[k] = false;
     }
+    sig.covered[0] = false;
     
     return sig;
 }
@@ -897,12 +920,10 @@ Signature DancingMatrix::getColumnSignature() const {
 void DancingMatrix::build_mapping_from_cols(const unordered_set<int>& blockCols, unordered_map<int, set<int>>& rowToCols, unordered_map<int, set<int>>& colToRows)
 {
     for (auto col : blockCols) {
-        ColumnHeader* c = &ColIndex[col];
-        Node* curR = c->down;
-        while (curR != c) {
-            rowToCols[curR->row].insert(col);
-            colToRows[col].insert(curR->row);
-            curR = curR->down;
+        DlxArena::index_t c = col;
+        for (DlxArena::index_t curR = dlx.D(c); curR != c; curR = dlx.D(curR)) {
+            rowToCols[dlx.ROW(curR)].insert(col);
+            colToRows[col].insert(dlx.ROW(curR));
         }
     }
 }
@@ -910,23 +931,23 @@ void DancingMatrix::build_mapping_from_cols(const unordered_set<int>& blockCols,
 void DancingMatrix::printMatrix() const
 {
     std::cout<< "Remain Matrix Nodes: " << std::endl;
-    ColumnHeader* current = (ColumnHeader*)root->right;
-    while(current != root)
+    DlxArena::index_t current = dlx.R(ROOT);
+    while(current != ROOT)
     {
-        std::cout << "Column " << current->col << " size: " << current->size << " ";
-        if(current->size > 0){
-            Node* cur = current->down;
+        std::cout << "Column " << dlx.C(current) << " size: " << colSize[current] << " ";
+        if(colSize[current] > 0){
+            DlxArena::index_t cur = dlx.D(current);
             std::cout << "{ Rows: ( ";
             while(cur != current)
             {
-                std::cout << cur->row + 1;
-                cur = cur->down;
+                std::cout << dlx.ROW(cur) + 1;
+                cur = dlx.D(cur);
                 if(cur != current)
                     std::cout << ", ";
             }
             std::cout << " ) } " << std::endl;
         }
-        current = (ColumnHeader*)current->right;
+        current = dlx.R(current);
     }
     std::cout << std::endl;
 }
@@ -940,71 +961,57 @@ void DancingMatrix::printBlocks( vector<Block>& blocks) const {
 
 void DancingMatrix::cover( int c )  
 {  
-    ColumnHeader* col = &ColIndex[c];  
-    col->right->left = col->left;  
-    col->left->right = col->right; 
+    DlxArena::index_t col = c;  
+    dlx.hlink[dlx.R(col)].left = dlx.L(col);  
+    dlx.hlink[dlx.L(col)].right = dlx.R(col); 
     colsSet.erase(c);
 
-    Node* curR, *curC;  
-    curC = col->down;  
-    while( curC != col )  
+    for( DlxArena::index_t curC = dlx.D(col); curC != col; curC = dlx.D(curC) )  
     {   
-        Node* noteR = curC;  
-
-        curR = noteR->right;  
-        while( curR != noteR )  
+        for( DlxArena::index_t curR = dlx.R(curC); curR != curC; curR = dlx.R(curR) )  
         {  
-            curR->down->up = curR->up;  
-            curR->up->down = curR->down;  
-            --ColIndex[curR->col].size;  
-
-            curR = curR->right;  
+            DlxArena::VLink v = dlx.vlink[curR];
+            dlx.vlink[v.down].up = v.up;  
+            dlx.vlink[v.up].down = v.down;  
+            --colSize[dlx.C(curR)];  
         }  
-        rowsSet.erase(curC->row);
-        curC = curC->down;  
+        rowsSet.erase(dlx.ROW(curC));
     }  
 }
 
 void DancingMatrix::uncover( int c )  
 {  
-    Node* curR, *curC;  
-    ColumnHeader* col = &ColIndex[c];  
-    curC = col->up;  
-    while( curC != col )  
+    DlxArena::index_t col = c;  
+    for( DlxArena::index_t curC = dlx.U(col); curC != col; curC = dlx.U(curC) )  
     {  
-        Node* noteR = curC;  
-
-        curR = curC->left;  
-        while( curR != noteR )  
+        for( DlxArena::index_t curR = dlx.L(curC); curR != curC; curR = dlx.L(curR) )  
         {  
-            ++ColIndex[curR->col].size;  
-            curR->down->up = curR;  
-            curR->up->down = curR;  
-
-            curR = curR->left;  
+            ++colSize[dlx.C(curR)];  
+            DlxArena::VLink v = dlx.vlink[curR];
+            dlx.vlink[v.down].up = curR;  
+            dlx.vlink[v.up].down = curR;  
         }  
-        rowsSet.insert(curC->row);
-        curC = curC->up;  
+        rowsSet.insert(dlx.ROW(curC));
     }  
-    col->right->left = col;  
-    col->left->right = col;  
+    dlx.hlink[dlx.R(col)].left = col;  
+    dlx.hlink[dlx.L(col)].right = col;  
     colsSet.insert(c);
 }
 
 void DancingMatrix::coverInBlock(int c, Block& block, set<int>& removed_rows){
 
-    ColumnHeader* col = &ColIndex[c];  
-    col->right->left = col->left;  
-    col->left->right = col->right;  
+    DlxArena::index_t col = c;  
+    dlx.hlink[dlx.R(col)].left = dlx.L(col);  
+    dlx.hlink[dlx.L(col)].right = dlx.R(col);  
     
     block.cols.erase(c); // 从块中移除列
+    block.stateHash ^= colKey[c];
+    bool trackSizes = block.colQueue.ready();
+    if (trackSizes) block.colQueue.remove(c);
 
-    Node* curR, *curC;  
-    curC = col->down;  
-
-    while( curC != col )  
+    for( DlxArena::index_t curC = dlx.D(col); curC != col; curC = dlx.D(curC) )  
     {    
-        int row_id = curC->row;
+        int row_id = dlx.ROW(curC);
         removed_rows.insert(row_id);
 
         if (isGraphSyncEnabled() && useIG) {
@@ -1012,34 +1019,32 @@ void DancingMatrix::coverInBlock(int c, Block& block, set<int>& removed_rows){
         }
         block.rows.erase(row_id); // 从块中移除行
 
-        curR = curC->right;  
-        while( curR != curC )  
+        for( DlxArena::index_t curR = dlx.R(curC); curR != curC; curR = dlx.R(curR) )  
         {          
-            curR->down->up = curR->up;  
-            curR->up->down = curR->down;  
-            --ColIndex[curR->col].size;
-            curR = curR->right;  
+            DlxArena::VLink v = dlx.vlink[curR];
+            dlx.vlink[v.down].up = v.up;  
+            dlx.vlink[v.up].down = v.down;  
+            --colSize[dlx.C(curR)];
+            if (trackSizes) block.colQueue.decrease(dlx.C(curR));
         }  
-
-        curC = curC->down;  
     } 
 }
 
 void DancingMatrix::uncoverInBlock(int c, Block& block){ 
-    ColumnHeader* col = &ColIndex[c];  
-    Node* curC = col->up; 
+    DlxArena::index_t col = c;  
+    bool trackSizes = block.colQueue.ready();
 
-    while( curC != col )  
+    for( DlxArena::index_t curC = dlx.U(col); curC != col; curC = dlx.U(curC) )  
     {  
-        int row_id = curC->row;
+        int row_id = dlx.ROW(curC);
  
-        Node* curR = curC->left;  
-        while( curR != curC )  
+        for( DlxArena::index_t curR = dlx.L(curC); curR != curC; curR = dlx.L(curR) )  
         {  
-            ++ColIndex[curR->col].size;
-            curR->down->up = curR;  
-            curR->up->down = curR;  
-            curR = curR->left;  
+            ++colSize[dlx.C(curR)];
+            if (trackSizes) block.colQueue.increase(dlx.C(curR));
+            DlxArena::VLink v = dlx.vlink[curR];
+            dlx.vlink[v.down].up = curR;  
+            dlx.vlink[v.up].down = curR;  
         }  
 
         block.rows.insert(row_id); // 将行添加到块中
@@ -1047,41 +1052,43 @@ void DancingMatrix::uncoverInBlock(int c, Block& block){
         if (isGraphSyncEnabled() && useIG) {
             incrementalGraph->reactivateRow(row_id); 
         }
-
-        curC = curC->up;  
     }  
 
-    col->right->left = col;  
-    col->left->right = col;  
+    dlx.hlink[dlx.R(col)].left = col;  
+    dlx.hlink[dlx.L(col)].right = col;  
     block.cols.insert(c);
+    block.stateHash ^= colKey[c];
+    if (trackSizes) block.colQueue.restore(c);
 }
 
-ColumnHeader* DancingMatrix::selectColumnHeuristic(const set<int>& cols) {
-    ColumnHeader* chosen = nullptr;
+col_id DancingMatrix::selectColumnHeuristic(const SparseSet& cols) {
+    col_id chosen = -1;
     int minSize = INT_MAX;
 
     for (int col : cols) {
         if (col < 1 || col > COLS) continue; // 跳过无效列
         int sz = getColSize(col);
 
-        if (sz < minSize) {
+        // 块内列的遍历顺序不固定，大小相同时取列号最小者
+        if (sz < minSize || (sz == minSize && col < chosen)) {
             minSize = sz;
-            chosen = getColumnHeader(col);
+            chosen = col;
         }
     }
     return chosen;
 }
 
-ColumnHeader* DancingMatrix::selectColumnByLinear(const set<int>& cols, int threshold) {
+col_id DancingMatrix::selectColumnByLinear(const SparseSet& cols, int threshold) {
     
-    ColumnHeader* bestCol = getColumnHeader(*cols.begin()); // 保底选择第一列
-    int bestSize = getColSize(bestCol->col);
+    col_id bestCol = *cols.begin(); // 保底选择第一列
+    int bestSize = getColSize(bestCol);
     
     for (int colId : cols) {
         int size = getColSize(colId);
         
-        if (size < bestSize) {
-            bestCol = getColumnHeader(colId);
+        // 块内列的遍历顺序不固定，大小相同时取列号最小者
+        if (size < bestSize || (size == bestSize && colId < bestCol)) {
+            bestCol = colId;
             bestSize = size;
         }
     }
@@ -1089,19 +1096,19 @@ ColumnHeader* DancingMatrix::selectColumnByLinear(const set<int>& cols, int thre
     return bestCol; // 保证非空返回
 }
 
-ColumnHeader* DancingMatrix::selectColumnByMinHeap(const set<int>& cols, int threshold) {
+col_id DancingMatrix::selectColumnByMinHeap(const SparseSet& cols, int threshold) {
     
     // 使用小根堆选择最小列
     priority_queue<ColumnInfo, vector<ColumnInfo>, greater<ColumnInfo>> minHeap;
     
     for (int colId : cols) {
         int size = getColSize(colId);
-        minHeap.push({colId, size, getColumnHeader(colId)});
+        minHeap.push({colId, size});
     }
     
     // 保底返回：记录第一个（最小size）列
     ColumnInfo firstCol = minHeap.top();
-    ColumnHeader* bestCol = firstCol.header;
+    col_id bestCol = firstCol.colId;
     int bestDistance = abs(firstCol.size - threshold);
     
     // 从小到大取出元素，寻找最接近阈值的列
@@ -1114,7 +1121,7 @@ ColumnHeader* DancingMatrix::selectColumnByMinHeap(const set<int>& cols, int thr
         // 更新最优列
         if (distance < bestDistance) {
             bestDistance = distance;
-            bestCol = current.header;
+            bestCol = current.colId;
         }
         
         // 早期退出优化：
@@ -1131,7 +1138,7 @@ ColumnHeader* DancingMatrix::selectColumnByMinHeap(const set<int>& cols, int thr
     return bestCol;  // 保证非空
 }
 
-ColumnHeader* DancingMatrix::selectOptimalColumn(const set<int>& cols) {
+col_id DancingMatrix::selectOptimalColumn(Block& block) {
     
     // if (cols.size() <= HEAP_THRESHOLD) {
     //     return selectColumnByLinear(cols, TARGET_THRESHOLD);
@@ -1140,43 +1147,42 @@ ColumnHeader* DancingMatrix::selectOptimalColumn(const set<int>& cols) {
     //     return selectColumnByMinHeap(cols, TARGET_THRESHOLD);
     // }
 
-    return selectColumnByLinear(cols, TARGET_THRESHOLD);
+    // 首次在该块上选列时建立分桶队列，此后由 coverInBlock/uncoverInBlock 增量维护
+    if (!block.colQueue.ready()) {
+        block.colQueue.build(block.cols, colSize.get());
+    }
+    return block.colQueue.top();
 }
 
-ColumnHeader* DancingMatrix::selectCol()
+col_id DancingMatrix::selectCol()
 {
-    ColumnHeader* choose = getColumnHeader(root->right->col), *cur=choose;  
-    while( cur != root )  
+    col_id choose = dlx.R(ROOT);
+    for( DlxArena::index_t cur = choose; cur != ROOT; cur = dlx.R(cur) )  
     {   //选择元素最少的列
-        int chooseSize = getColSize(choose->col);
-        int curSize = getColSize(cur->col);
-        if( chooseSize > curSize )  
+        if( getColSize(choose) > getColSize(cur) )  
             choose = cur;  
-        cur = getColumnHeader(cur->right->col);  
     } 
     return choose;
 }
 
 col_id DancingMatrix::getClosedSizeCol(const int expected_size) {
-    ColumnHeader* choose = (ColumnHeader*)root->right, *cur=choose;  
-    while( cur != root )  
+    col_id choose = dlx.R(ROOT);
+    for( DlxArena::index_t cur = choose; cur != ROOT; cur = dlx.R(cur) )  
     {   //选择接近预期大小的列
-        if( abs(choose->size - expected_size) > abs(cur->size - expected_size) )  
+        if( abs(colSize[choose] - expected_size) > abs(colSize[cur] - expected_size) )  
             choose = cur;  
-        cur = (ColumnHeader*)cur->right;  
     } 
-    return choose->col;
+    return choose;
 }
 
 col_id DancingMatrix::getSmallestSizeCol() {
-    ColumnHeader* choose = (ColumnHeader*)root->right, *cur=choose;  
-    while( cur != root )  
+    col_id choose = dlx.R(ROOT);
+    for( DlxArena::index_t cur = choose; cur != ROOT; cur = dlx.R(cur) )  
     {   //选择元素最少的列
-        if( choose->size > cur->size )  
+        if( colSize[choose] > colSize[cur] )  
             choose = cur;  
-        cur = (ColumnHeader*)cur->right;  
     } 
-    return choose->col;
+    return choose;
 }
 
 void PreProccess::extractNM(const std::string& line, int& n, int& m) {
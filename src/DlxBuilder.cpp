@@ -0,0 +1,102 @@
+#include "../include/DlxBuilder.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace DlxBuilder {
+
+void initHeaders(DlxArena& dlx, int cols, size_t nnz) {
+    dlx.reserve(static_cast<size_t>(cols) + 1 + nnz);
+    for (int i = 0; i <= cols; i++) {
+        dlx.allocate(i, -1);
+    }
+    for (int i = 0; i <= cols; i++) {
+        dlx.hlink[i].left = (i == 0) ? cols : i - 1;
+        dlx.hlink[i].right = (i == cols) ? 0 : i + 1;
+    }
+}
+
+void insertSorted(DlxArena& dlx, int* colSize, int* rowSize, index_t* rowHead, int r, int c) {
+    colSize[c]++;
+    rowSize[r]++;
+    index_t x = dlx.allocate(c, r);
+
+    index_t cur = c;
+    while (dlx.D(cur) != (index_t)c && dlx.ROW(dlx.D(cur)) < r)
+        cur = dlx.D(cur);
+
+    dlx.vlink[x].down = dlx.D(cur);
+    dlx.vlink[x].up = cur;
+    dlx.vlink[dlx.D(cur)].up = x;
+    dlx.vlink[cur].down = x;
+
+    if (rowHead[r] == 0) {
+        rowHead[r] = x;
+        return;
+    }
+
+    index_t head = rowHead[r];
+    cur = head;
+    while (dlx.R(cur) != head && dlx.C(dlx.R(cur)) < c)
+        cur = dlx.R(cur);
+
+    dlx.hlink[x].right = dlx.R(cur);
+    dlx.hlink[x].left = cur;
+    dlx.hlink[dlx.R(cur)].left = x;
+    dlx.hlink[cur].right = x;
+}
+
+void linkBulk(DlxArena& dlx, const CsrView& csr, int* colSize, int* rowSize, index_t* rowHead) {
+    // 第一遍：统计列大小
+    for (size_t k = 0; k < csr.nnz; k++) {
+        colSize[csr.colIndices[k]]++;
+    }
+
+    // 列尾指针，初始为列头自身；行按顺序处理，接到列尾即保持列内行号升序
+    std::vector<index_t> tail(static_cast<size_t>(csr.cols) + 1);
+    for (int c = 0; c <= csr.cols; c++) tail[c] = c;
+
+    for (int r = 0; r < csr.rows; r++) {
+        uint32_t begin = csr.rowOffsets[r];
+        uint32_t end = csr.rowOffsets[r + 1];
+        rowSize[r] = static_cast<int>(end - begin);
+        if (begin == end) continue;
+
+        // 行内列号严格升序，节点按读入顺序分配即按列号升序，直接成环
+        index_t first = 0, prev = 0;
+        for (uint32_t k = begin; k < end; k++) {
+            int c = csr.colIndices[k];
+            index_t x = dlx.allocate(c, r);
+
+            index_t t = tail[c];
+            dlx.vlink[x] = {t, static_cast<index_t>(c)};
+            dlx.vlink[t].down = x;
+            dlx.vlink[c].up = x;
+            tail[c] = x;
+
+            if (k == begin) {
+                first = x;
+            } else {
+                dlx.hlink[prev].right = x;
+                dlx.hlink[x].left = prev;
+            }
+            prev = x;
+        }
+        dlx.hlink[prev].right = first;
+        dlx.hlink[first].left = prev;
+        rowHead[r] = first;
+    }
+}
+
+bool sameStructure(const DlxArena& a, const DlxArena& b) {
+    if (a.size() != b.size()) return false;
+    for (index_t x = 0; x < a.size(); x++) {
+        if (a.U(x) != b.U(x) || a.D(x) != b.D(x) || a.L(x) != b.L(x) || a.R(x) != b.R(x) ||
+            a.C(x) != b.C(x) || a.ROW(x) != b.ROW(x)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,88 @@
+#include "../include/DnnfEnumerator.h"
+
+#include <algorithm>
+
+DnnfEnumerator::DnnfEnumerator(const DnnfStore& store, dnnf_id root)
+    : store_(store), root_(root) {}
+
+void DnnfEnumerator::expand() {
+    while (!work_.empty()) {
+        Pending p = work_.back();
+        work_.pop_back();
+        const DnnfNodeRecord& n = store_.node(p.node);
+        if (n.kind != DnnfKind::Decision && n.kind != DnnfKind::And) continue;  // TRUE 不占帧
+
+        uint32_t self = static_cast<uint32_t>(frames_.size());
+        frames_.push_back({p.node, p.parent, p.slot});
+        if (n.kind == DnnfKind::Decision) {
+            work_.push_back({n.b, self, 0});
+        } else {
+            // 逆序入栈，出栈时保持先序
+            for (uint32_t j = n.b; j-- > 0;) {
+                work_.push_back({store_.childBegin(n)[j], self, j});
+            }
+        }
+    }
+}
+
+bool DnnfEnumerator::next(std::vector<int>& rows) {
+    if (done_) return false;
+
+    if (!started_) {
+        started_ = true;
+        if (root_ == DnnfStore::FALSE_ID) {
+            done_ = true;
+            return false;
+        }
+        work_.push_back({root_, NONE, 0});
+        expand();
+    } else {
+        // 从后往前找可以沿链后移的决策帧
+        size_t i = frames_.size();
+        while (i > 0) {
+            const DnnfNodeRecord& n = store_.node(frames_[i - 1].node);
+            if (n.kind == DnnfKind::Decision && n.a != DnnfStore::FALSE_ID) break;
+            i--;
+        }
+        if (i == 0) {
+            done_ = true;
+            frames_.clear();
+            return false;
+        }
+
+        uint32_t f = static_cast<uint32_t>(i - 1);
+        frames_[f].node = store_.node(frames_[f].node).a;
+        frames_.resize(f + 1);
+
+        // 待展开的子电路按先序为：f 的新 hi，随后逐层向上是各祖先 AND 帧中位于其后的分块
+        tail_.clear();
+        tail_.push_back({store_.node(frames_[f].node).b, f, 0});
+        for (uint32_t c = f; frames_[c].parent != NONE; c = frames_[c].parent) {
+            const Frame& p = frames_[frames_[c].parent];
+            const DnnfNodeRecord& pn = store_.node(p.node);
+            if (pn.kind != DnnfKind::And) continue;
+            for (uint32_t j = frames_[c].slot + 1; j < pn.b; j++) {
+                tail_.push_back({store_.childBegin(pn)[j], frames_[c].parent, j});
+            }
+        }
+        work_.assign(tail_.rbegin(), tail_.rend());
+        expand();
+    }
+
+    rows.clear();
+    for (const Frame& fr : frames_) {
+        const DnnfNodeRecord& n = store_.node(fr.node);
+        if (n.kind == DnnfKind::Decision) rows.push_back(n.label);
+    }
+    return true;
+}
+
+uint64_t DnnfEnumerator::writeTo(std::ostream& out, uint64_t limit) {
+    return forEach([&](const std::vector<int>& rows) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (i) out << ' ';
+            out << rows[i] + 1;
+        }
+        out << '\n';
+    }, limit);
+}
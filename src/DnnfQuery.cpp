@@ -0,0 +1,137 @@
+#include "../include/DnnfQuery.h"
+
+#include <stdexcept>
+
+DnnfQuery::DnnfQuery(const DnnfStore& store, dnnf_id root, int numVars)
+    : store_(store), root_(root), numVars_(numVars), order_(store.reachable(root)) {
+    for (dnnf_id id : order_) {
+        const DnnfNodeRecord& n = store_.node(id);
+        if (n.kind == DnnfKind::Decision && (n.label < 0 || n.label >= numVars_)) {
+            throw std::runtime_error("d-DNNF 决策节点的行号超出变量范围");
+        }
+    }
+}
+
+std::vector<DNNFResult> DnnfQuery::nodeCounts() const {
+    std::vector<DNNFResult> val(store_.size());
+    for (dnnf_id id : order_) {
+        const DnnfNodeRecord& n = store_.node(id);
+        switch (n.kind) {
+            case DnnfKind::False:
+                val[id] = DNNFResult(0);
+                break;
+            case DnnfKind::True:
+                val[id] = DNNFResult(1);
+                break;
+            case DnnfKind::Decision:
+                val[id] = val[n.a] + val[n.b];
+                break;
+            case DnnfKind::And: {
+                DNNFResult product(1);
+                for (const dnnf_id* c = store_.childBegin(n); c != store_.childEnd(n); ++c) {
+                    product = product * val[*c];
+                }
+                val[id] = product;
+                break;
+            }
+        }
+    }
+    return val;
+}
+
+DNNFResult DnnfQuery::count() const {
+    return nodeCounts()[root_];
+}
+
+DNNFResult DnnfQuery::conditionedCount(const std::vector<int>& forced, const std::vector<int>& forbidden) const {
+    // 行状态：0 不限制，1 必选，2 禁选
+    std::vector<uint8_t> status(numVars_, 0);
+    for (int r : forbidden) {
+        if (r < 0 || r >= numVars_) throw std::out_of_range("行号超出范围: " + std::to_string(r + 1));
+        status[r] = 2;
+    }
+    size_t k = 0;
+    for (int r : forced) {
+        if (r < 0 || r >= numVars_) throw std::out_of_range("行号超出范围: " + std::to_string(r + 1));
+        if (status[r] == 2) return DNNFResult(0);  // 同时必选与禁选
+        if (status[r] == 0) k++;
+        status[r] = 1;
+    }
+
+    // poly[id * w + j]：恰好选中 j 个必选行的解数
+    const size_t w = k + 1;
+    std::vector<DNNFResult> poly(store_.size() * w);
+    std::vector<DNNFResult> acc(w);
+    for (dnnf_id id : order_) {
+        const DnnfNodeRecord& n = store_.node(id);
+        DNNFResult* out = &poly[size_t(id) * w];
+        switch (n.kind) {
+            case DnnfKind::False:
+                break;
+            case DnnfKind::True:
+                out[0] = DNNFResult(1);
+                break;
+            case DnnfKind::Decision: {
+                const DNNFResult* lo = &poly[size_t(n.a) * w];
+                const DNNFResult* hi = &poly[size_t(n.b) * w];
+                uint8_t s = status[n.label];
+                for (size_t j = 0; j < w; j++) {
+                    out[j] = lo[j];
+                    if (s == 0) out[j] = out[j] + hi[j];
+                    else if (s == 1 && j > 0) out[j] = out[j] + hi[j - 1];
+                }
+                break;
+            }
+            case DnnfKind::And: {
+                out[0] = DNNFResult(1);
+                for (const dnnf_id* c = store_.childBegin(n); c != store_.childEnd(n); ++c) {
+                    const DNNFResult* in = &poly[size_t(*c) * w];
+                    for (size_t j = 0; j < w; j++) {
+                        DNNFResult sum(0);
+                        for (size_t i = 0; i <= j; i++) {
+                            if (!out[i].isZero() && !in[j - i].isZero()) sum = sum + out[i] * in[j - i];
+                        }
+                        acc[j] = sum;
+                    }
+                    std::copy(acc.begin(), acc.end(), out);
+                }
+                break;
+            }
+        }
+    }
+    return poly[size_t(root_) * w + k];
+}
+
+std::vector<DNNFResult> DnnfQuery::marginals() const {
+    std::vector<DNNFResult> val = nodeCounts();
+    std::vector<DNNFResult> grad(store_.size());
+    std::vector<DNNFResult> result(numVars_);
+    std::vector<DNNFResult> suffix;
+    grad[root_] = DNNFResult(1);
+
+    // 编号降序即逆拓扑序，处理节点时其全部父节点的梯度都已累加完毕
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+        dnnf_id id = *it;
+        const DNNFResult g = grad[id];
+        if (g.isZero()) continue;
+
+        const DnnfNodeRecord& n = store_.node(id);
+        if (n.kind == DnnfKind::Decision) {
+            grad[n.a] = grad[n.a] + g;
+            grad[n.b] = grad[n.b] + g;
+            result[n.label] = result[n.label] + g * val[n.b];
+        } else if (n.kind == DnnfKind::And) {
+            const dnnf_id* c = store_.childBegin(n);
+            size_t m = n.b;
+            suffix.assign(m + 1, DNNFResult(1));
+            for (size_t i = m; i-- > 0;) suffix[i] = suffix[i + 1] * val[c[i]];
+
+            DNNFResult prefix(1);
+            for (size_t i = 0; i < m; i++) {
+                grad[c[i]] = grad[c[i]] + g * prefix * suffix[i + 1];
+                prefix = prefix * val[c[i]];
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,60 @@
+#include "../include/DnnfSampler.h"
+#include "../include/DnnfQuery.h"
+
+DnnfSampler::DnnfSampler(const DnnfStore& store, dnnf_id root, int numVars)
+    : store_(store), root_(root), counts_(DnnfQuery(store, root, numVars).nodeCounts()) {}
+
+bool DnnfSampler::sample(std::mt19937_64& rng, std::vector<int>& rows) const {
+    rows.clear();
+    if (counts_[root_].isZero()) return false;
+
+    thread_local std::vector<dnnf_id> stack;
+    stack.assign(1, root_);
+
+    while (!stack.empty()) {
+        dnnf_id id = stack.back();
+        stack.pop_back();
+        const DnnfNodeRecord& n = store_.node(id);
+
+        if (n.kind == DnnfKind::And) {
+            for (const dnnf_id* c = store_.childBegin(n); c != store_.childEnd(n); ++c) {
+                stack.push_back(*c);
+            }
+            continue;
+        }
+        if (n.kind != DnnfKind::Decision) continue;
+
+        // 决策链 (r1, (r2, ..., hi2), hi1)：选中某一行后转入它的 hi 子电路
+        if (counts_[id].rep().fitsU64()) {
+            uint64_t t = std::uniform_int_distribution<uint64_t>(0, counts_[id].rep().low() - 1)(rng);
+            while (t >= counts_[store_.node(id).b].rep().low()) {
+                t -= counts_[store_.node(id).b].rep().low();
+                id = store_.node(id).a;
+            }
+        } else {
+            BigCount t = BigCount::uniformBelow(counts_[id].rep(), rng);
+            while (t >= counts_[store_.node(id).b].rep()) {
+                t -= counts_[store_.node(id).b].rep();
+                id = store_.node(id).a;
+            }
+        }
+        rows.push_back(store_.node(id).label);
+        stack.push_back(store_.node(id).b);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    return true;
+}
+
+size_t DnnfSampler::sampleTo(std::ostream& out, size_t n, std::mt19937_64& rng) const {
+    std::vector<int> rows;
+    size_t written = 0;
+    for (; written < n && sample(rng, rows); written++) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (i) out << ' ';
+            out << rows[i] + 1;
+        }
+        out << '\n';
+    }
+    return written;
+}
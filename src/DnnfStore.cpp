@@ -0,0 +1,354 @@
+#include "../include/DnnfStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+DnnfStore::DnnfStore() {
+    clear();
+}
+
+void DnnfStore::clear() {
+    nodes_.clear();
+    children_.clear();
+    slots_.assign(1024, EMPTY);
+    decisionCount_ = 0;
+    andCount_ = 0;
+    lookups_ = 0;
+    probes_ = 0;
+    maxProbe_ = 0;
+    resizes_ = 0;
+    push(DnnfKind::False, -2, 0, 0);  // FALSE_ID
+    push(DnnfKind::True, -1, 0, 0);   // TRUE_ID
+}
+
+dnnf_id DnnfStore::push(DnnfKind kind, int32_t label, uint32_t a, uint32_t b) {
+    if (nodes_.size() >= UINT32_MAX) {
+        throw std::runtime_error("d-DNNF 节点数超过 32 位编号范围");
+    }
+    DnnfNodeRecord rec{};
+    rec.kind = kind;
+    rec.label = label;
+    rec.a = a;
+    rec.b = b;
+    nodes_.push_back(rec);
+    return static_cast<dnnf_id>(nodes_.size() - 1);
+}
+
+dnnf_id DnnfStore::makeDecision(int row, dnnf_id lo, dnnf_id hi, bool* created) {
+    size_t mask = slots_.size() - 1;
+    size_t i = hashKey(row, lo, hi) & mask;
+    size_t probe = 1;
+    lookups_++;
+
+    for (; slots_[i] != EMPTY; i = (i + 1) & mask, probe++) {
+        const DnnfNodeRecord& n = nodes_[slots_[i]];
+        if (n.label == row && n.a == lo && n.b == hi) {
+            probes_ += probe;
+            if (created) *created = false;
+            return slots_[i];
+        }
+    }
+    probes_ += probe;
+    if (probe > maxProbe_) maxProbe_ = probe;
+
+    dnnf_id id = push(DnnfKind::Decision, row, lo, hi);
+    slots_[i] = id;
+    decisionCount_++;
+    if (created) *created = true;
+
+    if (decisionCount_ > MAX_LOAD * slots_.size()) {
+        rehash(slots_.size() * 2);
+    }
+    return id;
+}
+
+void DnnfStore::rehash(size_t capacity) {
+    std::vector<dnnf_id> fresh(capacity, EMPTY);
+    size_t mask = capacity - 1;
+    for (dnnf_id id : slots_) {
+        if (id == EMPTY) continue;
+        const DnnfNodeRecord& n = nodes_[id];
+        size_t i = hashKey(n.label, n.a, n.b) & mask;
+        while (fresh[i] != EMPTY) i = (i + 1) & mask;
+        fresh[i] = id;
+    }
+    slots_.swap(fresh);
+    resizes_++;
+}
+
+dnnf_id DnnfStore::makeAnd(const dnnf_id* children, size_t n) {
+    if (children_.size() + n >= UINT32_MAX) {
+        throw std::runtime_error("d-DNNF 子节点数超过 32 位编号范围");
+    }
+    uint32_t begin = static_cast<uint32_t>(children_.size());
+    children_.insert(children_.end(), children, children + n);
+    andCount_++;
+    return push(DnnfKind::And, -3, begin, static_cast<uint32_t>(n));
+}
+
+size_t DnnfStore::bytes() const {
+    return nodes_.capacity() * sizeof(DnnfNodeRecord)
+         + children_.capacity() * sizeof(dnnf_id)
+         + slots_.capacity() * sizeof(dnnf_id);
+}
+
+std::string DnnfStore::summary() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "DNNF Store: nodes=" << size()
+        << " decision=" << decisionCount()
+        << " and=" << andCount()
+        << " children=" << childCount()
+        << " bytes=" << bytes()
+        << " bytesPerNode=" << bytesPerNode()
+        << " table=" << tableCapacity()
+        << " load=" << loadFactor()
+        << " avgProbe=" << averageProbes()
+        << " maxProbe=" << maxProbe_
+        << " resizes=" << resizes_;
+    return oss.str();
+}
+
+std::vector<dnnf_id> DnnfStore::reachable(dnnf_id root) const {
+    std::vector<char> seen(nodes_.size(), 0);
+    std::vector<dnnf_id> stack{root};
+    std::vector<dnnf_id> order;
+    seen[root] = 1;
+
+    while (!stack.empty()) {
+        dnnf_id id = stack.back();
+        stack.pop_back();
+        order.push_back(id);
+
+        const DnnfNodeRecord& n = nodes_[id];
+        auto visit = [&](dnnf_id c) {
+            if (!seen[c]) {
+                seen[c] = 1;
+                stack.push_back(c);
+            }
+        };
+        if (n.kind == DnnfKind::Decision) {
+            visit(n.a);
+            visit(n.b);
+        } else if (n.kind == DnnfKind::And) {
+            for (const dnnf_id* c = childBegin(n); c != childEnd(n); ++c) visit(*c);
+        }
+    }
+    std::sort(order.begin(), order.end());
+    return order;
+}
+
+void DnnfStore::writeNnf(const std::string& path, dnnf_id root, int numVars) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("无法写入文件: " + path);
+    }
+
+    // 先生成全部行，再写出带有行数与边数的文件头
+    std::vector<dnnf_id> order = reachable(root);
+    std::vector<uint32_t> line(nodes_.size(), 0);
+    std::unordered_map<int, uint32_t> literal;  // 文字 -> 行号
+    std::ostringstream body;
+    uint32_t lines = 0;
+    uint64_t edges = 0;
+
+    auto lit = [&](int l) {
+        auto it = literal.find(l);
+        if (it != literal.end()) return it->second;
+        body << "L " << l << '\n';
+        literal.emplace(l, lines);
+        return lines++;
+    };
+
+    // 每个节点的变量集合（升序行号）。零抑制语义下分支中未出现的行取假，
+    // 按标准 d-DNNF 语义它们却不受约束，因此分支要合取这些行的负文字（平滑）
+    std::vector<std::vector<int>> scope(nodes_.size());
+    std::vector<int> missing;
+    // 写出 A 节点：first 之后合取 scope \ sub 中各行的负文字，返回新行号
+    auto smoothAnd = [&](std::initializer_list<uint32_t> first, const std::vector<int>& full,
+                         const std::vector<int>& sub, int skip) {
+        missing.clear();
+        std::set_difference(full.begin(), full.end(), sub.begin(), sub.end(), std::back_inserter(missing));
+        std::vector<uint32_t> operands(first);
+        for (int r : missing) {
+            if (r != skip) operands.push_back(lit(-(r + 1)));
+        }
+        body << "A " << operands.size();
+        for (uint32_t o : operands) body << ' ' << o;
+        body << '\n';
+        edges += operands.size();
+        return lines++;
+    };
+
+    for (dnnf_id id : order) {
+        const DnnfNodeRecord& n = nodes_[id];
+        switch (n.kind) {
+            case DnnfKind::False:
+                body << "O 0 0\n";
+                break;
+            case DnnfKind::True:
+                body << "A 0\n";
+                break;
+            case DnnfKind::Decision: {
+                const std::vector<int>& lo = scope[n.a];
+                const std::vector<int>& hi = scope[n.b];
+                std::vector<int>& full = scope[id];
+                std::set_union(lo.begin(), lo.end(), hi.begin(), hi.end(), std::back_inserter(full));
+                full.insert(std::lower_bound(full.begin(), full.end(), n.label), n.label);
+
+                int var = n.label + 1;
+                uint32_t pos = lit(var), neg = lit(-var);
+                uint32_t hiAnd = smoothAnd({pos, line[n.b]}, full, hi, n.label);
+                uint32_t loAnd = smoothAnd({neg, line[n.a]}, full, lo, n.label);
+                body << "O " << var << " 2 " << hiAnd << ' ' << loAnd << '\n';
+                edges += 2;
+                break;
+            }
+            case DnnfKind::And: {
+                // 子电路的行集合互不相交，无需平滑
+                std::vector<int>& full = scope[id];
+                body << "A " << n.b;
+                for (const dnnf_id* c = childBegin(n); c != childEnd(n); ++c) {
+                    body << ' ' << line[*c];
+                    full.insert(full.end(), scope[*c].begin(), scope[*c].end());
+                }
+                body << '\n';
+                std::sort(full.begin(), full.end());
+                edges += n.b;
+                break;
+            }
+        }
+        line[id] = lines++;
+    }
+
+    // 根节点之外的行在任何解中都不选
+    if (root != FALSE_ID && static_cast<int>(scope[root].size()) < numVars) {
+        std::vector<int> all(numVars);
+        std::iota(all.begin(), all.end(), 0);
+        smoothAnd({line[root]}, all, scope[root], -1);
+    }
+
+    out << "nnf " << lines << ' ' << edges << ' ' << numVars << '\n' << body.str();
+    if (!out) {
+        throw std::runtime_error("写入 nnf 文件失败: " + path);
+    }
+}
+
+void DnnfStore::writeBinary(const std::string& path, dnnf_id root, int numVars) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("无法写入文件: " + path);
+    }
+
+    // 只写出可达节点并重新编号，终端节点固定为 0、1
+    std::vector<dnnf_id> order = reachable(root);
+    std::vector<dnnf_id> remap(nodes_.size(), 0);
+    std::vector<DnnfNodeRecord> records{nodes_[FALSE_ID], nodes_[TRUE_ID]};
+    std::vector<dnnf_id> children;
+    for (dnnf_id id : order) {
+        if (id == FALSE_ID || id == TRUE_ID) {
+            remap[id] = id;
+            continue;
+        }
+        DnnfNodeRecord rec = nodes_[id];
+        if (rec.kind == DnnfKind::Decision) {
+            rec.a = remap[rec.a];
+            rec.b = remap[rec.b];
+        } else if (rec.kind == DnnfKind::And) {
+            uint32_t begin = static_cast<uint32_t>(children.size());
+            for (const dnnf_id* c = childBegin(nodes_[id]); c != childEnd(nodes_[id]); ++c) {
+                children.push_back(remap[*c]);
+            }
+            rec.a = begin;
+        }
+        remap[id] = static_cast<dnnf_id>(records.size());
+        records.push_back(rec);
+    }
+
+    BinaryDnnfHeader header{};
+    std::memcpy(header.magic, BinaryDnnfHeader::MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.numVars = static_cast<uint32_t>(numVars);
+    header.nodeCount = static_cast<uint32_t>(records.size());
+    header.childCount = static_cast<uint32_t>(children.size());
+    header.root = remap[root];
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(DnnfNodeRecord));
+    out.write(reinterpret_cast<const char*>(children.data()), children.size() * sizeof(dnnf_id));
+    if (!out) {
+        throw std::runtime_error("写入二进制 d-DNNF 失败: " + path);
+    }
+}
+
+dnnf_id DnnfStore::readBinary(const std::string& path, int& numVars) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("无法打开文件: " + path);
+    }
+
+    BinaryDnnfHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, BinaryDnnfHeader::MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("不是二进制 d-DNNF 文件: " + path);
+    }
+    if (header.version != 1 || header.nodeCount < 2 || header.root >= header.nodeCount ||
+        header.numVars > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("不支持的二进制 d-DNNF 文件: " + path);
+    }
+
+    clear();
+    nodes_.resize(header.nodeCount);
+    children_.resize(header.childCount);
+    in.read(reinterpret_cast<char*>(nodes_.data()), nodes_.size() * sizeof(DnnfNodeRecord));
+    in.read(reinterpret_cast<char*>(children_.data()), children_.size() * sizeof(dnnf_id));
+    if (!in) {
+        clear();
+        throw std::runtime_error("二进制 d-DNNF 文件被截断: " + path);
+    }
+
+    // 校验 0、1 号为终端节点，子节点引用只指向更早的节点，决策行号小于 numVars，同时重建唯一表与统计；
+    // 损坏时恢复为只有终端节点的空存储
+    auto corrupt = [&]() {
+        clear();
+        throw std::runtime_error("二进制 d-DNNF 文件节点损坏: " + path);
+    };
+    if (nodes_[FALSE_ID].kind != DnnfKind::False || nodes_[TRUE_ID].kind != DnnfKind::True) corrupt();
+
+    size_t capacity = 1024;
+    for (dnnf_id id = 2; id < nodes_.size(); id++) {
+        const DnnfNodeRecord& n = nodes_[id];
+        bool valid = false;
+        if (n.kind == DnnfKind::Decision) {
+            valid = n.a < id && n.b < id && n.label >= 0 && static_cast<uint32_t>(n.label) < header.numVars;
+            decisionCount_++;
+        } else if (n.kind == DnnfKind::And) {
+            valid = uint64_t(n.a) + n.b <= children_.size() &&
+                    std::all_of(childBegin(n), childEnd(n), [id](dnnf_id c) { return c < id; });
+            andCount_++;
+        }
+        if (!valid) corrupt();
+    }
+    while (decisionCount_ > MAX_LOAD * capacity) capacity *= 2;
+
+    slots_.assign(capacity, EMPTY);
+    size_t mask = capacity - 1;
+    for (dnnf_id id = 2; id < nodes_.size(); id++) {
+        const DnnfNodeRecord& n = nodes_[id];
+        if (n.kind != DnnfKind::Decision) continue;
+        size_t i = hashKey(n.label, n.a, n.b) & mask;
+        while (slots_[i] != EMPTY) i = (i + 1) & mask;
+        slots_[i] = id;
+    }
+
+    numVars = static_cast<int>(header.numVars);
+    return header.root;
+}
@@ -106,7 +106,7 @@ private:
      * @param localComponentColumns 局部的分量列集合（输出）
      */
     void rebuildLocally(
-        const std::set<int>& restrictedRows,
+        const SparseSet& restrictedRows,
         std::vector<int>& localParent,
         std::vector<int>& localRank,
         std::vector<std::unordered_set<int>>& localComponentColumns) const 
@@ -249,22 +249,22 @@ public:
     void initialize(const DancingMatrix& matrix) {
         std::cerr << "开始初始化图..." << std::endl;
         
-        const ColumnHeader* root = matrix.getColumnHeader(0);
-        Node* curCol = root->right;
+        const DlxArena& dlx = matrix.dlx;
+        DlxArena::index_t curCol = dlx.R(DancingMatrix::ROOT);
         
         int colIndex = 1;
         size_t totalElements = 0;
         
-        while (curCol != root) {
+        while (curCol != DancingMatrix::ROOT) {
             std::vector<int> rowsInColumn;
-            Node* curRow = curCol->down;
+            DlxArena::index_t curRow = dlx.D(curCol);
             
             while (curRow != curCol) {
-                int row = curRow->row;
+                int row = dlx.ROW(curRow);
                 rowsInColumn.push_back(row);
                 rowStates[row].activeColumns.insert(colIndex);
                 totalElements++;
-                curRow = curRow->down;
+                curRow = dlx.D(curRow);
             }
             
             if (!rowsInColumn.empty()) {
@@ -286,7 +286,7 @@ public:
                 }
             }
             
-            curCol = curCol->right;
+            curCol = dlx.R(curCol);
             colIndex++;
         }
         
@@ -414,7 +414,7 @@ public:
      * @param rows 限定的行集合
      * @return 该行集合内的所有连通分量
      */
-    std::vector<Block> computeComponentsInRows(const std::set<int>& rows) const {
+    std::vector<Block> computeComponentsInRows(const SparseSet& rows) const {
         // 过滤出有效的行
         // std::unordered_set<int> validRows;
         // for (int row : rows) {
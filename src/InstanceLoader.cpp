@@ -0,0 +1,299 @@
+#include "../include/InstanceLoader.h"
+#include "../include/common.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        cerr << "无法打开文件: " << path << endl;
+        throw runtime_error("无法打开文件");
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw runtime_error("无法读取文件大小: " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) return;  // 空文件不做映射
+
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd_);
+        throw runtime_error("mmap 失败: " + path);
+    }
+    ::madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(addr);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+namespace {
+
+inline bool isBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+inline const char* skipBlank(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline const char* skipToken(const char* p, const char* end) {
+    p = skipBlank(p, end);
+    while (p < end && !isBlank(*p)) ++p;
+    return p;
+}
+
+// 取下一行 [lineBegin, lineEnd)，不含换行符
+inline bool nextLine(const char*& p, const char* end, const char*& lineBegin, const char*& lineEnd) {
+    if (p >= end) return false;
+    lineBegin = p;
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    lineEnd = nl ? nl : end;
+    p = nl ? nl + 1 : end;
+    return true;
+}
+
+} // namespace
+
+SparseInstance InstanceLoader::parseText(const std::string& file_path, int from) {
+    MappedFile file(file_path);
+    return parseBuffer(file.data(), file.data() + file.size(), from);
+}
+
+SparseInstance InstanceLoader::parseBuffer(const char* begin, const char* end, int from) {
+    SparseInstance inst;
+    const char* p = begin;
+    const char* lb = nullptr;
+    const char* le = nullptr;
+
+    if (!nextLine(p, end, lb, le)) {
+        throw runtime_error("实例文件为空");
+    }
+
+    int rows = 0, cols = 0;
+    if (from == 1) {
+        PreProccess::extractNM(string(lb, le), cols, rows);
+        nextLine(p, end, lb, le);  // 跳过 "p ec n" 行
+    } else {
+        const char* q = skipBlank(lb, le);
+        q = std::from_chars(q, le, cols).ptr;
+        q = skipBlank(q, le);
+        std::from_chars(q, le, rows);
+    }
+
+    inst.rows = rows;
+    inst.cols = cols;
+    inst.rowOffsets.reserve(static_cast<size_t>(rows) + 1);
+    inst.colIndices.reserve(static_cast<size_t>(end - p) / 3);
+    inst.rowOffsets.push_back(0);
+
+    int currentRow = 0;
+    while (currentRow < rows && nextLine(p, end, lb, le)) {
+        if (lb == le) continue;  // 跳过空行
+
+        // 跳过行首标记：.ec 的 "s"、run_set 的行长度，或 set_partitioning 的两个字段
+        const char* q = skipToken(lb, le);
+        if (from == 2) q = skipToken(q, le);
+
+        while (true) {
+            q = skipBlank(q, le);
+            int currentCol;
+            auto [ptr, ec] = std::from_chars(q, le, currentCol);
+            if (ec != std::errc()) break;
+            if (currentCol < 1 || currentCol > cols) {
+                cerr << "无效的列索引: " << currentCol << " 在行 " << currentRow + 1 << endl;
+                throw runtime_error("无效的列索引");
+            }
+            inst.colIndices.push_back(currentCol);
+            q = ptr;
+        }
+
+        // 行内列号规范为严格升序：舞蹈链的两种建立方式都依赖这一点，重复的列只保留一个
+        auto rowBegin = inst.colIndices.begin() + inst.rowOffsets.back();
+        if (!std::is_sorted(rowBegin, inst.colIndices.end()) ||
+            std::adjacent_find(rowBegin, inst.colIndices.end()) != inst.colIndices.end()) {
+            std::sort(rowBegin, inst.colIndices.end());
+            inst.colIndices.erase(std::unique(rowBegin, inst.colIndices.end()), inst.colIndices.end());
+        }
+
+        inst.rowOffsets.push_back(static_cast<uint32_t>(inst.colIndices.size()));
+        currentRow++;
+    }
+
+    // 文件行数不足时，剩余行视为空行
+    while (static_cast<int>(inst.rowOffsets.size()) <= rows) {
+        inst.rowOffsets.push_back(static_cast<uint32_t>(inst.colIndices.size()));
+    }
+
+    return inst;
+}
+
+bool InstanceLoader::isBinary(const char* data, size_t size) {
+    return size >= sizeof(BinaryInstanceHeader) &&
+           std::memcmp(data, BinaryInstanceHeader::MAGIC, sizeof(BinaryInstanceHeader::MAGIC)) == 0;
+}
+
+CsrView InstanceLoader::viewBinary(const char* data, size_t size) {
+    if (!isBinary(data, size)) {
+        throw runtime_error("不是二进制 CSR 实例");
+    }
+
+    BinaryInstanceHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != 1 || header.rows < 0 || header.cols < 0) {
+        throw runtime_error("不支持的二进制实例版本");
+    }
+
+    bool withColumnIndex = header.flags & BinaryInstanceHeader::HAS_COLUMN_INDEX;
+    // nnz 过大时下面的长度计算会溢出，行偏移也存不下
+    if (header.nnz > size || header.nnz > UINT32_MAX) {
+        throw runtime_error("二进制实例文件被截断");
+    }
+    size_t expected = sizeof(header)
+                    + (static_cast<size_t>(header.rows) + 1) * sizeof(uint32_t)
+                    + header.nnz * sizeof(int32_t);
+    if (withColumnIndex) {
+        expected += (static_cast<size_t>(header.cols) + 2) * sizeof(uint32_t)
+                  + header.nnz * sizeof(int32_t);
+    }
+    if (size < expected) {
+        throw runtime_error("二进制实例文件被截断");
+    }
+
+    CsrView v;
+    v.rows = header.rows;
+    v.cols = header.cols;
+    v.nnz = header.nnz;
+
+    const char* p = data + sizeof(header);
+    v.rowOffsets = reinterpret_cast<const uint32_t*>(p);
+    p += (static_cast<size_t>(header.rows) + 1) * sizeof(uint32_t);
+    v.colIndices = reinterpret_cast<const int32_t*>(p);
+    p += header.nnz * sizeof(int32_t);
+
+    if (withColumnIndex) {
+        v.colOffsets = reinterpret_cast<const uint32_t*>(p);
+        p += (static_cast<size_t>(header.cols) + 2) * sizeof(uint32_t);
+        v.colRows = reinterpret_cast<const int32_t*>(p);
+    }
+    validate(v);
+    return v;
+}
+
+void InstanceLoader::validate(const CsrView& v) {
+    // 偏移须从 0 开始单调不减且以 nnz 结束，否则按偏移取列号会越界
+    auto checkOffsets = [](const uint32_t* offsets, size_t count, size_t nnz) {
+        if (offsets[0] != 0 || offsets[count - 1] != nnz) return false;
+        for (size_t i = 1; i < count; i++) {
+            if (offsets[i] < offsets[i - 1]) return false;
+        }
+        return true;
+    };
+
+    if (!checkOffsets(v.rowOffsets, static_cast<size_t>(v.rows) + 1, v.nnz)) {
+        cerr << "二进制实例的行偏移不合法" << endl;
+        throw runtime_error("无效的行偏移");
+    }
+    for (int r = 0; r < v.rows; r++) {
+        for (uint32_t k = v.rowOffsets[r]; k < v.rowOffsets[r + 1]; k++) {
+            int32_t c = v.colIndices[k];
+            if (c < 1 || c > v.cols) {
+                cerr << "无效的列索引: " << c << " 在行 " << r + 1 << endl;
+                throw runtime_error("无效的列索引");
+            }
+            // convert 写出的行总是严格升序，其他来源的文件需重新转换
+            if (k > v.rowOffsets[r] && c <= v.colIndices[k - 1]) {
+                cerr << "行 " << r + 1 << " 的列号未按严格升序排列" << endl;
+                throw runtime_error("无效的列顺序");
+            }
+        }
+    }
+
+    if (!v.hasColumnIndex()) return;
+    if (!checkOffsets(v.colOffsets, static_cast<size_t>(v.cols) + 2, v.nnz)) {
+        cerr << "二进制实例的列偏移不合法" << endl;
+        throw runtime_error("无效的列偏移");
+    }
+    // 列索引须是 CSR 的转置：每列的行数与 CSR 中该列出现的次数相同，列内行号严格升序且该行确实含有此列。
+    // 行号不重复且每个 (行, 列) 都在 CSR 中，再加上每列总数相等，两者即为同一组非零元
+    std::vector<uint32_t> colCount(static_cast<size_t>(v.cols) + 1, 0);
+    for (size_t k = 0; k < v.nnz; k++) colCount[v.colIndices[k]]++;
+    for (int c = 0; c <= v.cols; c++) {
+        if (v.colOffsets[c + 1] - v.colOffsets[c] != colCount[c]) {
+            cerr << "列 " << c << " 的列索引与行数据不一致" << endl;
+            throw runtime_error("无效的列索引表");
+        }
+        for (uint32_t k = v.colOffsets[c]; k < v.colOffsets[c + 1]; k++) {
+            int32_t r = v.colRows[k];
+            if (r < 0 || r >= v.rows) {
+                cerr << "无效的行索引: " << r + 1 << endl;
+                throw runtime_error("无效的行索引");
+            }
+            const int32_t* rowBegin = v.colIndices + v.rowOffsets[r];
+            const int32_t* rowEnd = v.colIndices + v.rowOffsets[r + 1];
+            if ((k > v.colOffsets[c] && r <= v.colRows[k - 1]) || !std::binary_search(rowBegin, rowEnd, c)) {
+                cerr << "列 " << c << " 的列索引与行数据不一致" << endl;
+                throw runtime_error("无效的列索引表");
+            }
+        }
+    }
+}
+
+void InstanceLoader::writeBinary(const SparseInstance& inst, const std::string& out_path,
+                                 bool withColumnIndex) {
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw runtime_error("无法写入文件: " + out_path);
+    }
+
+    BinaryInstanceHeader header;
+    std::memcpy(header.magic, BinaryInstanceHeader::MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.flags = withColumnIndex ? BinaryInstanceHeader::HAS_COLUMN_INDEX : 0;
+    header.rows = inst.rows;
+    header.cols = inst.cols;
+    header.nnz = inst.nnz();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(inst.rowOffsets.data()),
+              inst.rowOffsets.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(inst.colIndices.data()),
+              inst.colIndices.size() * sizeof(int32_t));
+
+    if (withColumnIndex) {
+        // 计数排序得到按列分组的行号，行号在列内保持升序
+        std::vector<uint32_t> colOffsets(static_cast<size_t>(inst.cols) + 2, 0);
+        for (int32_t c : inst.colIndices) colOffsets[c + 1]++;
+        for (int c = 1; c <= inst.cols; c++) colOffsets[c + 1] += colOffsets[c];
+
+        std::vector<int32_t> colRows(inst.nnz());
+        std::vector<uint32_t> cursor(colOffsets.begin(), colOffsets.end() - 1);
+        for (int r = 0; r < inst.rows; r++) {
+            for (uint32_t k = inst.rowOffsets[r]; k < inst.rowOffsets[r + 1]; k++) {
+                colRows[cursor[inst.colIndices[k]]++] = r;
+            }
+        }
+
+        out.write(reinterpret_cast<const char*>(colOffsets.data()),
+                  colOffsets.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(colRows.data()),
+                  colRows.size() * sizeof(int32_t));
+    }
+
+    if (!out) {
+        throw runtime_error("写入二进制实例失败: " + out_path);
+    }
+}
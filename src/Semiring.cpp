@@ -0,0 +1,148 @@
+#include "../include/Semiring.h"
+
+#include <stdexcept>
+
+RowWeights RowWeights::load(const std::string& path, int numRows) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        throw std::runtime_error("无法打开权重文件: " + path);
+    }
+
+    RowWeights weights(numRows);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#' || line[start] == 'c') continue;
+
+        std::istringstream iss(line);
+        long row;
+        double w;
+        if (!(iss >> row >> w)) {
+            throw std::runtime_error("权重文件格式错误: " + path + ":" + std::to_string(lineNo));
+        }
+        if (row < 1 || row > numRows) {
+            throw std::runtime_error("权重文件行号超出范围: " + path + ":" + std::to_string(lineNo));
+        }
+        weights.set(static_cast<int>(row - 1), w);
+    }
+    return weights;
+}
+
+std::string RowWeights::defaultPath(const std::string& instancePath) {
+    return fs::path(instancePath).replace_extension(".weights").string();
+}
+
+static std::string formatReal(long double v) {
+    std::ostringstream oss;
+    oss << std::setprecision(17) << static_cast<double>(v);
+    return oss.str();
+}
+
+std::string WeightedSumSemiring::toString(value_type v) { return formatReal(v); }
+std::string MaxProductSemiring::toString(value_type v) { return formatReal(v); }
+std::string MinSumSemiring::toString(value_type v) { return formatReal(v); }
+
+template <typename S>
+typename S::value_type evaluateCircuit(const DnnfStore& store, dnnf_id root, const RowWeights& weights,
+                                       std::vector<int>* witness) {
+    using V = typename S::value_type;
+    if (witness) witness->clear();
+
+
+    std::vector<dnnf_id> order = store.reachable(root);
+    std::vector<V> val(store.size(), S::zero());
+    for (dnnf_id id : order) {
+        const DnnfNodeRecord& n = store.node(id);
+        switch (n.kind) {
+            case DnnfKind::False:
+                val[id] = S::zero();
+                break;
+            case DnnfKind::True:
+                val[id] = S::one();
+                break;
+            case DnnfKind::Decision:
+                val[id] = S::add(val[n.a], S::mul(rowWeight<S>(weights, n.label), val[n.b]));
+                break;
+            case DnnfKind::And: {
+                V product = S::one();
+                for (const dnnf_id* c = store.childBegin(n); c != store.childEnd(n); ++c) {
+                    product = S::mul(product, val[*c]);
+                }
+                val[id] = product;
+                break;
+            }
+        }
+    }
+
+    if constexpr (S::selective) {
+        if (witness) {
+            if (root != DnnfStore::FALSE_ID) {
+                std::vector<dnnf_id> stack{root};
+                while (!stack.empty()) {
+                    dnnf_id id = stack.back();
+                    stack.pop_back();
+                    const DnnfNodeRecord& n = store.node(id);
+                    if (n.kind == DnnfKind::And) {
+                        stack.insert(stack.end(), store.childBegin(n), store.childEnd(n));
+                        continue;
+                    }
+                    if (n.kind != DnnfKind::Decision) continue;
+
+                    // 沿决策链找到取到最优值的行
+                    while (store.node(id).a != DnnfStore::FALSE_ID) {
+                        const DnnfNodeRecord& d = store.node(id);
+                        V take = S::mul(rowWeight<S>(weights, d.label), val[d.b]);
+                        if (S::atLeast(take, val[d.a])) break;
+                        id = d.a;
+                    }
+                    witness->push_back(store.node(id).label);
+                    stack.push_back(store.node(id).b);
+                }
+                std::sort(witness->begin(), witness->end());
+            }
+        }
+    }
+    return val[root];
+}
+
+template DNNFResult evaluateCircuit<CountSemiring>(const DnnfStore&, dnnf_id, const RowWeights&, std::vector<int>*);
+template ModCount evaluateCircuit<ModCountSemiring>(const DnnfStore&, dnnf_id, const RowWeights&, std::vector<int>*);
+template LogCount evaluateCircuit<LogCountSemiring>(const DnnfStore&, dnnf_id, const RowWeights&, std::vector<int>*);
+template long double evaluateCircuit<WeightedSumSemiring>(const DnnfStore&, dnnf_id, const RowWeights&, std::vector<int>*);
+template long double evaluateCircuit<MaxProductSemiring>(const DnnfStore&, dnnf_id, const RowWeights&, std::vector<int>*);
+template long double evaluateCircuit<MinSumSemiring>(const DnnfStore&, dnnf_id, const RowWeights&, std::vector<int>*);
+
+bool isKnownSemiring(const std::string& name) {
+    return name == CountSemiring::name() || name == ModCountSemiring::name() ||
+           name == LogCountSemiring::name() || name == WeightedSumSemiring::name() ||
+           name == MaxProductSemiring::name() || name == MinSumSemiring::name();
+}
+
+bool semiringUsesWeights(const std::string& name) {
+    return name == WeightedSumSemiring::name() || name == MaxProductSemiring::name() || name == MinSumSemiring::name();
+}
+
+std::string evaluateCircuitByName(const std::string& semiring, const DnnfStore& store, dnnf_id root,
+                                  const RowWeights& weights, std::vector<int>* witness) {
+    if (semiring == CountSemiring::name()) {
+        return CountSemiring::toString(evaluateCircuit<CountSemiring>(store, root, weights, witness));
+    }
+    if (semiring == ModCountSemiring::name()) {
+        return ModCountSemiring::toString(evaluateCircuit<ModCountSemiring>(store, root, weights, witness));
+    }
+    if (semiring == LogCountSemiring::name()) {
+        return LogCountSemiring::toString(evaluateCircuit<LogCountSemiring>(store, root, weights, witness));
+    }
+    if (semiring == WeightedSumSemiring::name()) {
+        return WeightedSumSemiring::toString(evaluateCircuit<WeightedSumSemiring>(store, root, weights, witness));
+    }
+    if (semiring == MaxProductSemiring::name()) {
+        return MaxProductSemiring::toString(evaluateCircuit<MaxProductSemiring>(store, root, weights, witness));
+    }
+    if (semiring == MinSumSemiring::name()) {
+        return MinSumSemiring::toString(evaluateCircuit<MinSumSemiring>(store, root, weights, witness));
+    }
+    throw std::invalid_argument("Unknown semiring: " + semiring);
+}
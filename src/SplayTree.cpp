@@ -8,7 +8,59 @@ namespace splaytree {
 EulerTourTree::EulerTourTree(int id) : root(nullptr), treeId(id) {}
 
 EulerTourTree::~EulerTourTree() {
+    clear();
+}
+
+void EulerTourTree::clear() {
+    if (vertexIndex) {
+        for (int v : vertices) unroute(v);
+    }
     deleteTree(root);
+    root = nullptr;
+    for (auto& level : upperLevels) {
+        for (auto& [x, nodes] : level.nodes) {
+            for (auto& [y, node] : nodes) delete node;
+        }
+    }
+    vertices.clear();
+    nonTreeAdj.clear();
+    edgeNodes.clear();
+    upperLevels.clear();
+    vertexIndex = nullptr;
+    compId = -1;
+}
+
+namespace {
+// 每个线程至多缓存的空树数
+constexpr size_t kMaxFreeShells = 256;
+
+std::vector<std::unique_ptr<EulerTourTree>>& freeShells() {
+    thread_local std::vector<std::unique_ptr<EulerTourTree>> shells;
+    return shells;
+}
+}
+
+std::unique_ptr<EulerTourTree> EulerTourTree::acquire(int id) {
+    auto& shells = freeShells();
+    if (shells.empty()) return std::make_unique<EulerTourTree>(id);
+    std::unique_ptr<EulerTourTree> tree = std::move(shells.back());
+    shells.pop_back();
+    tree->treeId = id;
+    return tree;
+}
+
+void EulerTourTree::recycle(std::unique_ptr<EulerTourTree> tree) {
+    if (!tree) return;
+    tree->clear();
+    auto& shells = freeShells();
+    if (shells.size() < kMaxFreeShells) shells.push_back(std::move(tree));
+}
+
+void EulerTourTree::attachIndex(std::vector<EulerTourTree*>* index) {
+    if (index == vertexIndex) return;
+    for (int v : vertices) unroute(v);
+    vertexIndex = index;
+    for (int v : vertices) route(v);
 }
 
 void EulerTourTree::deleteTree(Node* x) {
@@ -22,8 +74,18 @@ void EulerTourTree::deleteTree(Node* x) {
 void EulerTourTree::updateSize(Node* x) {
     if (!x) return;
     x->size = 1;
-    if (x->left) x->size += x->left->size;
-    if (x->right) x->size += x->right->size;
+    x->ntSum = x->nt;
+    x->teSum = x->te;
+    if (x->left) {
+        x->size += x->left->size;
+        x->ntSum += x->left->ntSum;
+        x->teSum += x->left->teSum;
+    }
+    if (x->right) {
+        x->size += x->right->size;
+        x->ntSum += x->right->ntSum;
+        x->teSum += x->right->teSum;
+    }
 }
 
 void EulerTourTree::rotate(Node* n) {
@@ -54,8 +116,6 @@ void EulerTourTree::rotate(Node* n) {
     if (g) {
         if (p == g->left) g->left = n;
         else g->right = n;
-    } else {
-        root = n;
     }
 
     updateSize(p);
@@ -65,6 +125,12 @@ void EulerTourTree::rotate(Node* n) {
 // Splay操作：将节点n旋转到根位置
 void EulerTourTree::splay(Node* n) {
     if (!n) return;
+    splayNode(n);
+    root = n;
+}
+
+void EulerTourTree::splayNode(Node* n) {
+    if (!n) return;
 
     while (n->parent) {
         Node* p = n->parent;
@@ -80,7 +146,51 @@ void EulerTourTree::splay(Node* n) {
         }
         rotate(n);
     }
-    root = n;
+}
+
+Node* EulerTourTree::joinNodes(Node* leftTree, Node* rightTree) {
+    if (!leftTree) return rightTree;
+    if (!rightTree) return leftTree;
+
+    Node* maxNode = leftTree;
+    while (maxNode->right) maxNode = maxNode->right;
+    splayNode(maxNode);
+    maxNode->right = rightTree;
+    rightTree->parent = maxNode;
+    updateSize(maxNode);
+    return maxNode;
+}
+
+// 把 n 所在的欧拉序列旋转为以 n 开头
+Node* EulerTourTree::rerootNode(Node* n) {
+    splayNode(n);
+    Node* leftPart = n->left;
+    if (!leftPart) return n;
+    leftPart->parent = nullptr;
+    n->left = nullptr;
+    updateSize(n);
+    return joinNodes(n, leftPart);
+}
+
+// 从序列中摘下 n（不释放），返回剩余部分的根
+Node* EulerTourTree::removeNode(Node* n) {
+    splayNode(n);
+    Node* left = n->left;
+    Node* right = n->right;
+    if (left) left->parent = nullptr;
+    if (right) right->parent = nullptr;
+    n->left = n->right = nullptr;
+    updateSize(n);
+    return joinNodes(left, right);
+}
+
+Node* EulerTourTree::findMarked(Node* r, int Node::*own, int Node::*sum) {
+    Node* n = r;
+    while (true) {
+        if (n->left && n->left->*sum > 0) n = n->left;
+        else if (n->*own > 0) return n;
+        else n = n->right;
+    }
 }
 
 void EulerTourTree::updateSizeToRoot(Node* n) {
@@ -158,19 +268,132 @@ Node* EulerTourTree::concatenate(Node* leftTree, Node* rightTree) {
 }
 
 void EulerTourTree::mergeTrees(EulerTourTree* other) {
+    if (!vertexIndex) vertexIndex = other->vertexIndex;
     vertices.insert(other->vertices.begin(), other->vertices.end());
-    nonTreeEdges.insert(other->nonTreeEdges.begin(), other->nonTreeEdges.end());
+    for (int v : other->vertices) route(v);
+    // 两棵树顶点不相交，邻接表整体搬过来即可
+    for (auto& [x, adj] : other->nonTreeAdj) {
+        nonTreeAdj[x] = std::move(adj);
+    }
 
     for (auto& [v, edges] : other->edgeNodes) {
         for (auto& [u, node] : edges) {
             edgeNodes[v][u] = node;
         }
     }
+    // 高层森林同样按顶点不相交，逐层搬过来
+    if (upperLevels.size() < other->upperLevels.size()) upperLevels.resize(other->upperLevels.size());
+    for (size_t i = 0; i < other->upperLevels.size(); ++i) {
+        for (auto& [x, nodes] : other->upperLevels[i].nodes) upperLevels[i].nodes[x] = std::move(nodes);
+        for (auto& [x, adj] : other->upperLevels[i].nonTreeAdj) upperLevels[i].nonTreeAdj[x] = std::move(adj);
+    }
 
     other->root = nullptr;
     other->vertices.clear();
-    other->nonTreeEdges.clear();
+    other->nonTreeAdj.clear();
     other->edgeNodes.clear();
+    other->upperLevels.clear();
+}
+
+NodeTable& EulerTourTree::levelNodes(int i) {
+    if (i == 0) return edgeNodes;
+    if (upperLevels.size() < static_cast<size_t>(i)) upperLevels.resize(i);
+    return upperLevels[i - 1].nodes;
+}
+
+AdjTable& EulerTourTree::levelAdj(int i) {
+    if (i == 0) return nonTreeAdj;
+    if (upperLevels.size() < static_cast<size_t>(i)) upperLevels.resize(i);
+    return upperLevels[i - 1].nonTreeAdj;
+}
+
+Node* EulerTourTree::levelVertex(int i, int x) {
+    auto& nodes = levelNodes(i)[x];
+    auto it = nodes.find(x);
+    if (it != nodes.end()) return it->second;
+    Node* node = new Node(x);
+    nodes[x] = node;
+    return node;
+}
+
+void EulerTourTree::linkLevelEdge(int i, int x, int y, int level) {
+    Node* treeX = rerootNode(levelVertex(i, x));
+    Node* treeY = rerootNode(levelVertex(i, y));
+
+    Node* edgeXY = new Node(x, y);
+    Node* edgeYX = new Node(y, x);
+    if (i != level) {
+        edgeXY->te = edgeXY->teSum = 0;
+        edgeYX->te = edgeYX->teSum = 0;
+    }
+    edgeXY->level = edgeYX->level = level;
+    auto& nodes = levelNodes(i);
+    nodes[x][y] = edgeXY;
+    nodes[y][x] = edgeYX;
+
+    // 合并: treeX -> xy -> treeY -> yx
+    joinNodes(joinNodes(joinNodes(treeX, edgeXY), treeY), edgeYX);
+}
+
+void EulerTourTree::cutLevelEdge(int i, int x, int y) {
+    auto& nodes = levelNodes(i);
+    Node* edgeXY = nodes[x][y];
+    Node* edgeYX = nodes[y][x];
+
+    splayNode(edgeXY);
+    Node* L = edgeXY->left;
+    Node* R = edgeXY->right;
+    if (L) L->parent = nullptr;
+    if (R) R->parent = nullptr;
+    edgeXY->left = edgeXY->right = nullptr;
+
+    // 欧拉序为 [P] xy [Q] yx [S] 或 [P] yx [Q] xy [S]：Q 自成一棵树，P 与 S 拼成另一棵
+    bool inRight = R && findRoot(edgeYX) == R;
+    splayNode(edgeYX);
+    Node* L2 = edgeYX->left;
+    Node* R2 = edgeYX->right;
+    if (L2) L2->parent = nullptr;
+    if (R2) R2->parent = nullptr;
+    edgeYX->left = edgeYX->right = nullptr;
+    if (inRight) joinNodes(L, R2);
+    else joinNodes(L2, R);
+
+    delete edgeXY;
+    delete edgeYX;
+    nodes[x].erase(y);
+    nodes[y].erase(x);
+}
+
+void EulerTourTree::moveVertex(int x, EulerTourTree* to) {
+    vertices.erase(x);
+    to->vertices.insert(x);
+    to->route(x);
+
+    auto nodes = edgeNodes.find(x);
+    if (nodes != edgeNodes.end()) {
+        to->edgeNodes[x] = std::move(nodes->second);
+        edgeNodes.erase(nodes);
+    }
+    auto adj = nonTreeAdj.find(x);
+    if (adj != nonTreeAdj.end()) {
+        to->nonTreeAdj[x] = std::move(adj->second);
+        nonTreeAdj.erase(adj);
+    }
+
+    if (to->upperLevels.size() < upperLevels.size()) to->upperLevels.resize(upperLevels.size());
+    for (size_t i = 0; i < upperLevels.size(); ++i) {
+        auto& from = upperLevels[i];
+        auto levelNodesIt = from.nodes.find(x);
+        if (levelNodesIt != from.nodes.end()) {
+            to->upperLevels[i].nodes[x] = std::move(levelNodesIt->second);
+            from.nodes.erase(levelNodesIt);
+        }
+        auto levelAdjIt = from.nonTreeAdj.find(x);
+        if (levelAdjIt != from.nonTreeAdj.end()) {
+            to->upperLevels[i].nonTreeAdj[x] = std::move(levelAdjIt->second);
+            from.nonTreeAdj.erase(levelAdjIt);
+        }
+    }
 }
 
 
@@ -208,6 +431,7 @@ void EulerTourTree::addVertex(int v) {
     if (vertices.count(v)) return;
     
     vertices.insert(v);
+    route(v);
     Node* node = new Node(v);
     edgeNodes[v][v] = node;
     root = node;
@@ -336,106 +560,63 @@ Node* EulerTourTree::findEdgeNodeDFS(Node* subtree, int u, int v) {
 // Cut操作：删除边u-v
 std::pair<std::unique_ptr<EulerTourTree>, std::unique_ptr<EulerTourTree>> EulerTourTree::cut(int u, int v, int newTreeIdU, int newTreeIdV) {
     
-    reroot(u);
-    
     if (!edgeNodes.count(u) || !edgeNodes[u].count(v)) {
         // std::cerr << "Error: edge not found.\n";
         return {nullptr, nullptr};
     }
 
-    Node* edgeUV = edgeNodes[u][v];
-    Node* edgeVU = edgeNodes[v][u];
+    // 边在 F_0..F_level 中都有出现，逐层删去
+    int level = edgeNodes[u][v]->level;
+    for (int i = level; i >= 0; --i) cutLevelEdge(i, u, v);
 
-    splay(edgeUV);
-    // 此时结构：[L(u的其它边)] uv [R(v的子树 + vu + u的其它边)]
-    Node* L = edgeUV->left;
-    Node* R = edgeUV->right;
-    
-    edgeUV->left = nullptr;
-    edgeUV->right = nullptr;
-    if (L) L->parent = nullptr;
-    if (R) R->parent = nullptr;
+    Node* T_u = findRoot(getRepresentative(u));
+    Node* T_v = findRoot(getRepresentative(v));
 
-    splay(edgeVU);
-    // 此时结构：[Mid(v的子树)] vu [R2(u的剩余部分)]
-    Node* T_v = edgeVU->left;
-    Node* R2 = edgeVU->right;
-
-    if (T_v) T_v->parent = nullptr;
-    if (R2) R2->parent = nullptr;
-
-    // 重新连接 L 和 R2，形成 T_u
-    Node* T_u = join(L, R2);
-
-    delete edgeUV;
-    delete edgeVU;
-    
-    edgeNodes[u].erase(v);
-    edgeNodes[v].erase(u);
-    if (edgeNodes[u].empty()) edgeNodes.erase(u);
-    if (edgeNodes[v].empty()) edgeNodes.erase(v);
-    
     auto treeU = std::make_unique<EulerTourTree>(newTreeIdU);
     auto treeV = std::make_unique<EulerTourTree>(newTreeIdV);
+    treeU->vertexIndex = vertexIndex;
+    treeV->vertexIndex = vertexIndex;
 
-    treeU->root = T_u;
-    treeV->root = T_v;
-
-    // 后续的操作不需要在每次Cut进行，应该推迟到所有Cut完成后统一处理
-    EulerTourTree* T_small;
-    EulerTourTree* T_large;
-
-    if ((T_u ? T_u->size : 0) <= (T_v ? T_v->size : 0)) {
-        T_small = treeU.get();
-        T_large = treeV.get();
-    } else {
-        T_small = treeV.get();
-        T_large = treeU.get();
-    }
-
-    // 分配顶点
+    // 按 F_0 的两侧分配顶点，各层节点与非树邻接随顶点移走
     std::vector<Node*> nodes;
-    T_small->collectNodes(T_small->root, nodes);
-    auto oldEdgeNodes = std::move(edgeNodes);
-    
+    collectNodes(T_u, nodes);
     for (Node* node : nodes) {
-        T_small->vertices.insert(node->u);
-        vertices.erase(node->u);
-
-        if (node->isEdge()) {
-            T_small->vertices.insert(node->v);
-            vertices.erase(node->v);
-
-            T_small->edgeNodes[node->u][node->v] = node;
-            oldEdgeNodes[node->u].erase(node->v);
-            if (oldEdgeNodes[node->u].empty())
-                oldEdgeNodes.erase(node->u);
-        } else {
-            T_small->edgeNodes[node->u][node->u] = node;
-            oldEdgeNodes[node->u].erase(node->u);
-            if (oldEdgeNodes[node->u].empty())
-                oldEdgeNodes.erase(node->u);
-        }
+        if (!node->isEdge()) moveVertex(node->u, treeU.get());
+    }
+    nodes.clear();
+    collectNodes(T_v, nodes);
+    for (Node* node : nodes) {
+        if (!node->isEdge()) moveVertex(node->u, treeV.get());
     }
 
-    T_large->vertices = vertices;
-    T_large->edgeNodes = std::move(oldEdgeNodes);
-
-    for (const Edge& e : nonTreeEdges) {
-        bool inSmallU = T_small->vertices.count(e.u);
-        bool inSmallV = T_small->vertices.count(e.v);
-
-        if (inSmallU && inSmallV) {
-            T_small->nonTreeEdges.insert(e);
-        } else {
-            T_large->nonTreeEdges.insert(e);
+    // 跨两侧的非树边不再属于任何一棵树，两端都删去
+    struct Crossing { int level, x, w; };
+    std::vector<Crossing> crossing;
+    for (int i = 0; i < treeU->levelCount(); ++i) {
+        for (auto& [x, adj] : treeU->levelAdj(i)) {
+            for (int w : adj) {
+                if (!treeU->vertices.count(w)) crossing.push_back({i, x, w});
+            }
         }
     }
+    for (const Crossing& c : crossing) {
+        auto& adjU = treeU->levelAdj(c.level);
+        adjU[c.x].erase(c.w);
+        if (adjU[c.x].empty()) adjU.erase(c.x);
+        treeU->adjustNonTreeDegree(c.x, -1, c.level);
+        auto& adjV = treeV->levelAdj(c.level);
+        adjV[c.w].erase(c.x);
+        if (adjV[c.w].empty()) adjV.erase(c.w);
+        treeV->adjustNonTreeDegree(c.w, -1, c.level);
+    }
+    treeU->root = findRoot(treeU->getRepresentative(u));
+    treeV->root = findRoot(treeV->getRepresentative(v));
     
     root = nullptr;
     vertices.clear();
-    nonTreeEdges.clear();
+    nonTreeAdj.clear();
     edgeNodes.clear();
+    upperLevels.clear();
     
     return {std::move(treeU), std::move(treeV)};
 }
@@ -514,107 +695,147 @@ std::pair<Node*, Node*> EulerTourTree::deleteEdge(int u, int v) {
 }
 
 // 寻找替代边
-Edge EulerTourTree::findReplacementEdge(Node* rootU, Node* rootV) {
-
-    for (const Edge& e : nonTreeEdges) {
-        Node* nodeU = getRepresentative(e.u);
-        Node* nodeV = getRepresentative(e.v);
+Edge EulerTourTree::findReplacementEdge(int i, int u, int v) {
+    Node* nodeU = levelVertex(i, u);
+    Node* nodeV = levelVertex(i, v);
+    // 小侧在 F_i 中至多是原树的一半，以它的一个顶点节点为锚
+    Node* small = (findRoot(nodeU)->size <= findRoot(nodeV)->size) ? nodeU : nodeV;
+
+    // 小侧层级为 i 的树边全部升到 i + 1 层，小侧在 F_{i+1} 中连成一棵树
+    for (Node* r = findRoot(small); r->teSum > 0; r = findRoot(small)) {
+        Node* e = findMarked(r, &Node::te, &Node::teSum);
+        e->te = 0;
+        splayNode(e);
+        updateSize(e);
+        edgeNodes[e->u][e->v]->level = i + 1;
+        edgeNodes[e->v][e->u]->level = i + 1;
+        linkLevelEdge(i + 1, e->u, e->v, i + 1);
+    }
 
-        if (!nodeU || !nodeV) continue;
-    
-        Node* rU = findRoot(nodeU);
-        Node* rV = findRoot(nodeV);
-        
-        if ((rU == rootU && rV == rootV) || (rU == rootV && rV == rootU)) {
-            return e;
-        }
+    // 另一端也在小侧的非树边升到 i + 1 层，第一条跨两侧的即为替代边
+    for (Node* r = findRoot(small); r->ntSum > 0; r = findRoot(small)) {
+        Node* n = findMarked(r, &Node::nt, &Node::ntSum);
+        int x = n->u;
+        int w = *levelAdj(i)[x].begin();
+        bool inside = findRoot(levelVertex(i, w)) == r;
+        Edge e(x, w);
+        eraseNonTreeEdge(i, e);
+        if (!inside) return e;
+        insertNonTreeEdge(i + 1, e);
     }
-    
     return Edge(-1, -1);
 }
 
-// 带替换的Cut操作
-std::unique_ptr<EulerTourTree> EulerTourTree::cutWithReplacement(int u, int v) {
-    reroot(u); 
-
-    auto [treeU, treeV] = deleteEdge(u, v);
-    if (!treeU || !treeV) {
-        // 边不存在或删除失败
-        return nullptr;
+void EulerTourTree::adjustNonTreeDegree(int x, int delta, int level) {
+    if (level > 0) {
+        Node* node = levelVertex(level, x);
+        node->nt += delta;
+        splayNode(node);
+        updateSize(node);
+        return;
     }
+    Node* node = getVertexRepresentative(x);
+    if (!node) return;
+    node->nt += delta;
+    splay(node);
+    updateSize(node);
+}
 
-    root = treeU;  // 当前对象保留为 u 所在的树
-
-    Edge replacement = findReplacementEdge(treeU, treeV);
+void EulerTourTree::insertNonTreeEdge(int level, const Edge& e) {
+    auto& adj = levelAdj(level);
+    adj[e.u].insert(e.v);
+    adj[e.v].insert(e.u);
+    adjustNonTreeDegree(e.u, 1, level);
+    adjustNonTreeDegree(e.v, 1, level);
+}
 
-    if (replacement.u != -1) {
-        nonTreeEdges.erase(replacement);
+bool EulerTourTree::eraseNonTreeEdge(int level, const Edge& e) {
+    auto& adj = levelAdj(level);
+    auto it = adj.find(e.u);
+    if (it == adj.end() || !it->second.erase(e.v)) return false;
+    if (it->second.empty()) adj.erase(it);
+    auto jt = adj.find(e.v);
+    jt->second.erase(e.u);
+    if (jt->second.empty()) adj.erase(jt);
+    adjustNonTreeDegree(e.u, -1, level);
+    adjustNonTreeDegree(e.v, -1, level);
+    return true;
+}
 
-        root = joinTreesViaEdge(treeU, treeV, replacement.u, replacement.v);
-        return nullptr; // 没有产生新分量
-    } else {
-        auto newTree = std::make_unique<EulerTourTree>(-1);
+void EulerTourTree::addNonTreeEdge(const Edge& e) {
+    if (hasNonTreeEdge(e)) return;
+    insertNonTreeEdge(0, e);
+}
 
-        Node* T_small = (getSize(treeU) < getSize(treeV)) ? treeU : treeV;
-        Node* T_large = (T_small == treeU) ? treeV : treeU;
+void EulerTourTree::removeNonTreeEdge(const Edge& e) {
+    int level = nonTreeLevel(e);
+    if (level >= 0) eraseNonTreeEdge(level, e);
+}
 
-        // 分配顶点
-        std::vector<Node*> nodes;
-        collectNodes(T_small, nodes);
-        
-        // 遍历 small 树的节点，将其移出
-        for (Node* node : nodes) {
-            int currU = node->u;
-            int currV = node->v;
-        
-            // 移动 Vertices
-            if (vertices.count(currU)) {
-                vertices.erase(currU);
-                newTree->vertices.insert(currU);
-            }
-            if (currV != -1 && vertices.count(currV)) { // 处理边的另一端
-                 vertices.erase(currV);
-                 newTree->vertices.insert(currV);
-            }
+void EulerTourTree::setNonTreeEdges(const std::unordered_set<Edge, EdgeHash>& edges) {
+    for (int i = 0; i < levelCount(); ++i) {
+        auto& adj = levelAdj(i);
+        for (auto& [x, neighbors] : adj) {
+            adjustNonTreeDegree(x, -static_cast<int>(neighbors.size()), i);
+        }
+        adj.clear();
+    }
+    for (const Edge& e : edges) addNonTreeEdge(e);
+}
 
-            // 移动EdgeNodes
-            if (currV != -1) {
-                newTree->edgeNodes[currU][currV] = node;
-                edgeNodes[currU].erase(currV);
-                if (edgeNodes[currU].empty()) edgeNodes.erase(currU);
-            } else {
-                newTree->edgeNodes[currU][currU] = node;
-                edgeNodes[currU].erase(currU);
-                if (edgeNodes[currU].empty()) edgeNodes.erase(currU);
+std::unordered_set<Edge, EdgeHash> EulerTourTree::getNonTreeEdges() const {
+    std::unordered_set<Edge, EdgeHash> edges;
+    for (int i = 0; i < levelCount(); ++i) {
+        const auto& adj = (i == 0) ? nonTreeAdj : upperLevels[i - 1].nonTreeAdj;
+        for (const auto& [x, neighbors] : adj) {
+            for (int w : neighbors) {
+                if (x < w) edges.emplace(x, w);
             }
         }
+    }
+    return edges;
+}
 
-        auto it = nonTreeEdges.begin();
-        while (it != nonTreeEdges.end()) {
-            bool inSmallU = newTree->vertices.count(it->u);
-            bool inSmallV = newTree->vertices.count(it->v);
+// 带替换的Cut操作（HDT）：从边的层级往下逐层找替代边，
+// 在第 i 层找到时作为层级 i 的树边连回 F_0..F_i；各层都没有则分裂
+std::unique_ptr<EulerTourTree> EulerTourTree::cutWithReplacement(int u, int v) {
+    auto it = edgeNodes.find(u);
+    if (it == edgeNodes.end() || !it->second.count(v)) {
+        // 边不存在
+        return nullptr;
+    }
 
-            if (inSmallU && inSmallV) {
-                newTree->nonTreeEdges.insert(*it);
-                it = nonTreeEdges.erase(it); // 安全删除并移动迭代器
-            } else {
-                ++it;
-            }
-        }
+    int level = it->second.at(v)->level;
+    for (int i = level; i >= 0; --i) cutLevelEdge(i, u, v);
 
-        newTree->root = T_small;
-        root = T_large;
+    for (int i = level; i >= 0; --i) {
+        Edge replacement = findReplacementEdge(i, u, v);
+        if (replacement.u == -1) continue;
 
-        if (newTree->vertices.count(u)) {
-            newTree->edgeNodes[u].erase(v);
-            edgeNodes[v].erase(u);
-        } else { 
-            newTree->edgeNodes[v].erase(u);
-            edgeNodes[u].erase(v);
-        }
+        for (int j = i; j >= 0; --j) linkLevelEdge(j, replacement.u, replacement.v, i);
+        root = findRoot(getRepresentative(u));
+        return nullptr; // 没有产生新分量
+    }
+
+    Node* treeU = findRoot(getRepresentative(u));
+    Node* treeV = findRoot(getRepresentative(v));
+    Node* T_small = (getSize(treeU) < getSize(treeV)) ? treeU : treeV;
+    Node* T_large = (T_small == treeU) ? treeV : treeU;
 
-        return newTree;
+    auto newTree = acquire(-1);
+    newTree->vertexIndex = vertexIndex;
+
+    // 没有替代边说明小侧各层的非树边都在小侧内部，随顶点整体移走
+    thread_local std::vector<Node*> nodes;
+    nodes.clear();
+    collectNodes(T_small, nodes);
+    for (Node* node : nodes) {
+        if (!node->isEdge()) moveVertex(node->u, newTree.get());
     }
+
+    newTree->root = T_small;
+    root = T_large;
+    return newTree;
 }
 
 // 快速切除边界边
@@ -624,6 +845,18 @@ void EulerTourTree::cutBoundary(int v, int u) {
     // 确保边存在
     if (!edgeNodes.count(v) || !edgeNodes[v].count(u)) return;
 
+    // v 是叶子，高层森林里直接摘下这条边的两个出现
+    int level = edgeNodes[v][u]->level;
+    for (int i = 1; i <= level; ++i) {
+        auto& nodes = levelNodes(i);
+        for (auto [a, b] : {std::make_pair(v, u), std::make_pair(u, v)}) {
+            Node* edge = nodes[a][b];
+            removeNode(edge);
+            delete edge;
+            nodes[a].erase(b);
+        }
+    }
+
     // 删除 (v,u)
     if (edgeNodes[v].count(u)) {
         Node* edgeVU = edgeNodes[v][u];
@@ -674,23 +907,39 @@ void EulerTourTree::removeVertex(int v) {
     
     // std::cout << "Removing vertex " << v << "\n";
 
+    // 删除相关的非树边，只需访问 v 在各层的邻接表
+    for (int i = 0; i < levelCount(); ++i) {
+        auto& adjMap = levelAdj(i);
+        auto adj = adjMap.find(v);
+        if (adj == adjMap.end()) continue;
+        for (int w : adj->second) {
+            auto wt = adjMap.find(w);
+            if (wt == adjMap.end()) continue;
+            wt->second.erase(v);
+            if (wt->second.empty()) adjMap.erase(wt);
+            adjustNonTreeDegree(w, -1, i);
+        }
+        adjMap.erase(v);
+    }
+
     Node* nodeV = getRepresentative(v);
     if (nodeV) {
         deleteOccurrence(nodeV);
     }
+    for (auto& levelForest : upperLevels) {
+        auto it = levelForest.nodes.find(v);
+        if (it == levelForest.nodes.end()) continue;
+        auto self = it->second.find(v);
+        if (self != it->second.end()) {
+            removeNode(self->second);
+            delete self->second;
+        }
+        levelForest.nodes.erase(it);
+    }
     
     vertices.erase(v);
+    unroute(v);
     edgeNodes.erase(v);
-    
-    // 删除相关的非树边 - 使用迭代器安全删除
-    auto edgeIt = nonTreeEdges.begin();
-    while (edgeIt != nonTreeEdges.end()) {
-        if (edgeIt->u == v || edgeIt->v == v) {
-            edgeIt = nonTreeEdges.erase(edgeIt);
-        } else {
-            ++edgeIt;
-        }
-    }
 }
 
 // 获取顶点度数（用于判断是否为边界顶点）
@@ -750,9 +999,9 @@ void EulerTourTree::printEulerTour() const {
     std::cout << std::endl;
     
     // 打印非树边
-    if (!nonTreeEdges.empty()) {
+    if (!nonTreeAdj.empty()) {
         std::cout << "Non-tree edges: ";
-        for (const Edge& e : nonTreeEdges) {
+        for (const Edge& e : getNonTreeEdges()) {
             std::cout << "(" << e.u << "," << e.v << ") ";
         }
         std::cout << std::endl;
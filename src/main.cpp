@@ -1,14 +1,40 @@
 #include "../include/DXD.h"
+#include "../include/DnnfQuery.h"
+#include "../include/DnnfEnumerator.h"
+#include "../include/DnnfSampler.h"
+#include "../include/Semiring.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 static Logger logger("../run_results.txt");  // 全局日志
 // const string muti_thread_dxd_log_file = "../muti_thread_dxd_log.csv";
 static const int DEFAULT_THREADS = 8;  // 线程数
 
+// 替换全局 operator new，按线程累计调用次数，ettbench 据此报告更新过程中真实的堆分配次数。
+// 计数器是无析构的 thread_local 标量，静态初始化之前的分配也能安全计数
+static thread_local uint64_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
 // 算法类型枚举
 enum class algorithm_type {
     dxz,
     dxd,
-    mdxd
+    mdxd,
+    convert,
+    buildbench,
+    cachebench,
+    query,
+    countbench,
+    ettbench
 };
 
 // 将字符串转换为枚举
@@ -16,12 +42,525 @@ algorithm_type parseAlgorithmType(const std::string& name) {
     if (name == "dxz") return algorithm_type::dxz;
     if (name == "dxd") return algorithm_type::dxd;
     if (name == "mdxd") return algorithm_type::mdxd;
+    if (name == "convert") return algorithm_type::convert;
+    if (name == "buildbench") return algorithm_type::buildbench;
+    if (name == "cachebench") return algorithm_type::cachebench;
+    if (name == "query") return algorithm_type::query;
+    if (name == "countbench") return algorithm_type::countbench;
+    if (name == "ettbench") return algorithm_type::ettbench;
     throw std::invalid_argument("Unknown algorithm type: " + name);
 }
 
-// ./main <algorithm> <input> <read_mode> [pool_size]
+// 命令行中 --name=value 形式的可选参数，其余参数按位置解析
+struct SolverOptions {
+    CacheMode cacheMode = CacheMode::Verified;  // --cache=verified|fingerprint
+    size_t cacheBudget = 0;                     // --cache-mem=<size>，如 512M、2G，0 表示不限制
+    std::string exportNnf;                      // --export-nnf=<file>，c2d 格式
+    std::string exportBin;                      // --export-bin=<file>，二进制格式
+    size_t samples = 0;                         // --samples=N，搜索后均匀抽取 N 个解
+    uint64_t seed = 1;                          // --seed=S
+    std::string samplesOut;                     // --samples-out=<file>，默认标准输出
+    std::string enumerate;                      // --enumerate=<file|->，逐个写出全部解
+    uint64_t enumerateLimit = UINT64_MAX;       // --enumerate-limit=N
+    std::string semiring;                       // --semiring=count|sum|maxprod|minsum
+    std::string weights;                        // --weights=<file>，默认为实例旁的 .weights 文件
+    CountMode countMode = CountMode::Exact;     // --count=exact|mod
+    ConnectivityGraph connectivity = ConnectivityGraph::Clique;  // --conn=clique|bipartite，仅 ett 使用
+
+    // 未指定权重文件时使用 base 旁的同名 .weights 文件；计数半环不需要权重
+    void resolveWeights(const std::string& base) {
+        if (semiring.empty() || !weights.empty() || !semiringUsesWeights(semiring)) return;
+        weights = RowWeights::defaultPath(base);
+        if (!fs::exists(weights)) {
+            throw std::runtime_error("缺少行权重文件: " + weights + "（可用 --weights=<file> 指定）");
+        }
+    }
+
+    void configure(DanceDNNF& solver) const {
+        solver.setCacheMode(cacheMode);
+        solver.setCacheBudget(cacheBudget);
+        solver.setExportPaths(exportNnf, exportBin);
+        solver.setSampling(samples, seed, samplesOut);
+        solver.setEnumeration(enumerate, enumerateLimit);
+        solver.setSemiring(semiring, weights);
+        solver.setCountMode(countMode);
+    }
+};
+
+// 取出 argv 中的可选参数，并将位置参数前移，返回位置参数个数
+int extractOptions(int argc, char* argv[], SolverOptions& options) {
+    int positional = 0;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i == 0 || arg.rfind("--", 0) != 0) {
+            argv[positional++] = argv[i];
+            continue;
+        }
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+        std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+        if (name == "cache") {
+            options.cacheMode = parseCacheMode(value);
+        } else if (name == "cache-mem") {
+            options.cacheBudget = parseMemorySize(value);
+        } else if (name == "export-nnf" && !value.empty()) {
+            options.exportNnf = value;
+        } else if (name == "export-bin" && !value.empty()) {
+            options.exportBin = value;
+        } else if (name == "samples") {
+            options.samples = std::stoull(value);
+        } else if (name == "seed") {
+            options.seed = std::stoull(value);
+        } else if (name == "samples-out" && !value.empty()) {
+            options.samplesOut = value;
+        } else if (name == "enumerate" && !value.empty()) {
+            options.enumerate = value;
+        } else if (name == "enumerate-limit") {
+            options.enumerateLimit = std::stoull(value);
+        } else if (name == "semiring" && isKnownSemiring(value)) {
+            options.semiring = value;
+        } else if (name == "weights" && !value.empty()) {
+            options.weights = value;
+        } else if (name == "count") {
+            options.countMode = parseCountMode(value);
+        } else if (name == "conn") {
+            options.connectivity = parseConnectivityGraph(value);
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    return positional;
+}
+
+// 计数缓存争用测试：线程数从 1 倍增到 maxThreads，每个线程对 numKeys 个随机列集合反复查找，
+// 未命中则写入，分别测试单分片（等价于原先的单锁表）与默认分片数
+void runCacheBench(int numKeys, int maxThreads, long opsPerThread, CacheMode mode) {
+    const int MAX_COL = 256;
+    std::mt19937_64 gen(12345);
+    std::vector<SparseSet> keys;
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> colKey(MAX_COL + 1);
+    for (auto& k : colKey) k = gen();
+
+    keys.reserve(numKeys);
+    for (int i = 0; i < numKeys; i++) {
+        std::vector<int> cols;
+        int len = 8 + static_cast<int>(gen() % 56);
+        for (int j = 0; j < len; j++) cols.push_back(1 + static_cast<int>(gen() % MAX_COL));
+        keys.emplace_back(cols);
+        uint64_t h = 0;
+        for (int c : keys.back()) h ^= colKey[c];
+        hashes.push_back(h);
+    }
+
+    std::cout << "缓存争用测试: " << numKeys << " 个键, 每线程 " << opsPerThread
+              << " 次操作, 模式 " << cacheModeName(mode) << ", 硬件线程 "
+              << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (size_t shards : {size_t(1), CountCache::DEFAULT_SHARDS}) {
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            CountCache cache(mode, shards);
+            auto start = std::chrono::high_resolution_clock::now();
+
+            #pragma omp parallel num_threads(threads)
+            {
+                uint64_t x = 0x9E3779B97F4A7C15ULL * (omp_get_thread_num() + 1);
+                DNNFResult out;
+                dnnf_id node;
+                for (long op = 0; op < opsPerThread; op++) {
+                    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                    size_t k = x % keys.size();
+                    if (!cache.lookup(hashes[k], keys[k], out, node)) {
+                        cache.insert(hashes[k], keys[k], DNNFResult(k), DnnfStore::TRUE_ID);
+                    }
+                }
+            }
+
+            double seconds = std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            double mops = threads * static_cast<double>(opsPerThread) / seconds / 1e6;
+            std::cout << "分片 " << std::setw(2) << cache.shardCount()
+                      << "  线程 " << std::setw(2) << threads
+                      << "  " << std::setw(8) << mops << " Mops/s"
+                      << "  命中率 " << 100.0 * cache.hits() / (cache.hits() + cache.misses()) << "%"
+                      << std::endl;
+        }
+    }
+}
+
+// 查询二进制电路：总解数、条件解数与每行的边际解数。
+// conditions 为逗号分隔的行号（从 1 开始），+r 表示必选、-r 表示禁选，"-" 表示无条件
+void runQuery(const std::string& circuitFile, const std::string& conditions, const std::string& marginalsFile,
+              const SolverOptions& options) {
+    DnnfStore store;
+    int numVars = 0;
+    dnnf_id root = store.readBinary(circuitFile, numVars);
+    DnnfQuery query(store, root, numVars);
+
+    std::vector<int> forced, forbidden;
+    if (conditions != "-") {
+        std::stringstream ss(conditions);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.size() < 2 || (item[0] != '+' && item[0] != '-')) {
+                throw std::invalid_argument("Invalid condition: " + item);
+            }
+            int row = std::stoi(item.substr(1)) - 1;
+            (item[0] == '+' ? forced : forbidden).push_back(row);
+        }
+    }
+
+    auto timed = [](auto f) {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto value = f();
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        return std::make_pair(value, ms);
+    };
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "电路: " << circuitFile << " (" << query.reachableNodes() << " 个节点, "
+              << numVars << " 个变量)" << std::endl;
+
+    auto total = timed([&] { return query.count(); });
+    std::cout << "Count: " << total.first.toString() << "  (" << total.second << " ms)" << std::endl;
+
+    if (!forced.empty() || !forbidden.empty()) {
+        auto cond = timed([&] { return query.conditionedCount(forced, forbidden); });
+        std::cout << "Conditioned count [" << conditions << "]: " << cond.first.toString()
+                  << "  (" << cond.second << " ms)" << std::endl;
+    }
+
+    auto marg = timed([&] { return query.marginals(); });
+    std::ofstream file;
+    if (!marginalsFile.empty()) {
+        file.open(marginalsFile, std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("无法写入文件: " + marginalsFile);
+    }
+    std::ostream& out = marginalsFile.empty() ? std::cout : file;
+    size_t nonzero = 0;
+    for (int r = 0; r < numVars; r++) {
+        if (marg.first[r].isZero()) continue;
+        out << r + 1 << ' ' << marg.first[r].toString() << '\n';
+        nonzero++;
+    }
+    std::cout << "Marginals: " << nonzero << " 行出现在至少一个解中  (" << marg.second << " ms)";
+    if (!marginalsFile.empty()) std::cout << " -> " << marginalsFile;
+    std::cout << std::endl;
+
+    if (options.samples > 0) {
+        std::ofstream samplesFile;
+        if (!options.samplesOut.empty()) {
+            samplesFile.open(options.samplesOut, std::ios::trunc);
+            if (!samplesFile.is_open()) throw std::runtime_error("无法写入文件: " + options.samplesOut);
+        }
+        std::ostream& sout = options.samplesOut.empty() ? std::cout : samplesFile;
+        DnnfSampler sampler(store, root, numVars);
+        std::mt19937_64 rng(options.seed);
+        auto drawn = timed([&] { return sampler.sampleTo(sout, options.samples, rng); });
+        std::cout << "Samples: " << drawn.first << "  (" << drawn.second << " ms, "
+                  << std::setprecision(0) << drawn.first / std::max(drawn.second / 1000.0, 1e-9) << "/s)";
+        if (!options.samplesOut.empty()) std::cout << " -> " << options.samplesOut;
+        std::cout << std::endl;
+    }
+
+    if (!options.enumerate.empty()) {
+        std::ofstream enumFile;
+        if (options.enumerate != "-") {
+            enumFile.open(options.enumerate, std::ios::trunc);
+            if (!enumFile.is_open()) throw std::runtime_error("无法写入文件: " + options.enumerate);
+        }
+        std::ostream& eout = (options.enumerate == "-") ? std::cout : enumFile;
+        DnnfEnumerator enumerator(store, root);
+        auto written = timed([&] { return enumerator.writeTo(eout, options.enumerateLimit); });
+        std::cout << std::setprecision(3) << "Enumerated: " << written.first << "  (" << written.second << " ms)";
+        if (options.enumerate != "-") std::cout << " -> " << options.enumerate;
+        std::cout << std::endl;
+    }
+
+    if (!options.semiring.empty()) {
+        RowWeights weights = options.weights.empty() ? RowWeights(numVars) : RowWeights::load(options.weights, numVars);
+        std::vector<int> best;
+        auto value = timed([&] { return evaluateCircuitByName(options.semiring, store, root, weights, &best); });
+        std::cout << std::setprecision(3) << "Semiring " << options.semiring << ": " << value.first
+                  << "  (" << value.second << " ms)" << std::endl;
+        if (!best.empty()) {
+            std::cout << "Best cover:";
+            for (int r : best) std::cout << ' ' << r + 1;
+            std::cout << std::endl;
+        }
+    }
+}
+
+// 计数类型加法/乘法热路径的微基准：n 对随机值逐元素求和、求积，取 repeat 次中的最短耗时（ns/次）。
+// 输入为小于 2^30 的随机值，积仍在 64 位内；large 为真时取其立方（约 2^90），精确计数走大整数路径。
+template <typename C>
+void benchCountOps(const char* name, const std::vector<uint64_t>& seeds, bool large, int repeat) {
+    const size_t n = seeds.size() / 2;
+    std::vector<C> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = C(seeds[2 * i]);
+        b[i] = C(seeds[2 * i + 1]);
+        if (large) {
+            a[i] = a[i] * a[i] * a[i];
+            b[i] = b[i] * b[i] * b[i];
+        }
+    }
+
+    size_t zeros = 0;
+    auto time = [&](auto op) {
+        double best = 1e300;
+        for (int r = 0; r < repeat; r++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < n; i++) out[i] = op(a[i], b[i]);
+            best = std::min(best, std::chrono::duration<double, std::nano>(
+                std::chrono::high_resolution_clock::now() - start).count() / n);
+            zeros += out[n / 2].isZero();
+        }
+        return best;
+    };
+    double add = time([](const C& x, const C& y) { return x + y; });
+    double mul = time([](const C& x, const C& y) { return x * y; });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << std::left << std::setw(6) << name << std::setw(6) << (large ? "2^90" : "2^30") << std::right
+              << std::setw(3) << sizeof(C) << " B/值  add " << std::setw(7) << add
+              << " ns  mul " << std::setw(7) << mul << " ns" << (zeros ? "  (含零值)" : "") << std::endl;
+}
+
+// 读取 /proc/self/status 中的内存字段（KB），如 "VmRSS:"、"VmHWM:"；不可用时返回 0
+static size_t procStatusKiB(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0) return std::stoull(line.substr(field.size()));
+    }
+    return 0;
+}
+
+// 将进程的峰值常驻内存（VmHWM）重置为当前值，Linux 4.0 起支持；不支持时返回 false。
+// 先把堆中空闲的内存还给系统，否则前一次运行释放的内存会被下一次复用，增量偏小
+static bool resetPeakRss() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5" << std::flush;
+    return clearRefs.good() && procStatusKiB("VmHWM:") > 0;
+}
+
+// 求解器路径上的计数类型对比：在同一实例上分别用精确计数与多模数计数（--count=mod）做单线程 DXD 搜索（ett），
+// 报告 repeat 次中最短的搜索耗时、搜索结束时计数缓存的占用，以及加载与搜索期间峰值常驻内存的增量。
+// 每次都重新加载实例，缓存从空开始。
+static void runSolverCountBench(const std::string& instanceFile, int readMode, int repeat, const SolverOptions& options) {
+    Logger quiet("/dev/null", false);
+    std::cout << "实例: " << instanceFile << ", 单线程 DXD 搜索, 重复 " << repeat << " 次取最小值" << std::endl;
+
+    std::string exact;
+    for (CountMode mode : {CountMode::Exact, CountMode::Modular}) {
+        double best = 1e300;
+        size_t cacheBytes = 0, peakKiB = 0;
+        bool tracked = true;
+        std::string value;
+        for (int i = 0; i < repeat; i++) {
+            tracked &= resetPeakRss();
+            const size_t before = procStatusKiB("VmRSS:");
+            {
+                DanceDNNF solver(instanceFile, readMode, quiet, false, true, 1, false, options.connectivity);
+                solver.setCacheMode(options.cacheMode);
+                solver.setCacheBudget(options.cacheBudget);
+                solver.setCountMode(mode);
+                solver.startDXD();
+                if (solver.timeout) throw std::runtime_error("DXD 搜索超时: " + instanceFile);
+                best = std::min(best, solver.searchTime * 1000);
+                cacheBytes = solver.getCacheMemory();
+                value = solver.solutionCount;
+            }
+            const size_t hwm = procStatusKiB("VmHWM:");
+            if (tracked && hwm > before) peakKiB = std::max(peakKiB, hwm - before);
+        }
+        if (mode == CountMode::Exact) exact = value;
+
+        std::ostringstream peak;
+        if (tracked) peak << std::fixed << std::setprecision(2) << peakKiB / 1024.0 << " MB";
+        else peak << "-";
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::left << std::setw(6) << (mode == CountMode::Modular ? ModCountSemiring::name() : CountSemiring::name())
+                  << std::right << std::setw(10) << best << " ms  缓存 " << std::setprecision(2) << std::setw(8)
+                  << cacheBytes / (1024.0 * 1024.0) << " MB  峰值增量 " << std::setw(9) << peak.str() << "  " << value << std::endl;
+        if (mode == CountMode::Modular) {
+            std::cout << "CRT 还原与精确计数" << (exact == value ? "一致" : "不一致") << "（精确范围 2^"
+                      << ModCount::rep_type::BOUND_BITS << "）" << std::endl;
+        }
+    }
+}
+
+// 计数类型对比：先在电路上分别用对数域、精确与多模数计数求解数，再对三种表示的加法/乘法做微基准。
+// circuitFile 为 "-" 时只做微基准。
+void runCountBench(const std::string& circuitFile, int repeat) {
+    if (circuitFile != "-") {
+        DnnfStore store;
+        int numVars = 0;
+        dnnf_id root = store.readBinary(circuitFile, numVars);
+        RowWeights weights(numVars);
+
+        auto bench = [&](auto semiring) {
+            using S = decltype(semiring);
+            double best = 1e300;
+            std::string value;
+            for (int i = 0; i < repeat; i++) {
+                auto start = std::chrono::high_resolution_clock::now();
+                auto v = evaluateCircuit<S>(store, root, weights);
+                best = std::min(best, std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count());
+                value = S::toString(v);
+            }
+            std::cout << std::fixed << std::setprecision(3)
+                      << std::left << std::setw(6) << S::name() << std::right
+                      << std::setw(10) << best << " ms  " << std::setw(3) << sizeof(typename S::value_type)
+                      << " B/值  " << value << std::endl;
+            return value;
+        };
+
+        std::cout << "电路: " << circuitFile << " (" << store.size() << " 个节点), 重复 " << repeat << " 次取最小值" << std::endl;
+        bench(LogCountSemiring{});
+        std::string exact = bench(CountSemiring{});
+        std::string mod = bench(ModCountSemiring{});
+        std::cout << "CRT 还原与精确计数" << (exact == mod ? "一致" : "不一致") << "（精确范围 2^"
+                  << ModCount::rep_type::BOUND_BITS << "）" << std::endl;
+    }
+
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> seeds(1 << 16);
+    for (uint64_t& x : seeds) x = (rng() >> 34) | 1;
+    std::cout << "加法/乘法微基准: " << seeds.size() / 2 << " 对值, 重复 " << repeat << " 次取最小值" << std::endl;
+    for (bool large : {false, true}) {
+        benchCountOps<LogCount>("log", seeds, large, repeat);
+        benchCountOps<ExactCount>("exact", seeds, large, repeat);
+        benchCountOps<ModCount>("mod", seeds, large, repeat);
+    }
+}
+
+// 欧拉回路树动态连通性基准：与串行搜索一样只保留最大的连通分量，做 walks 轮随机删除：
+// 每步随机删除剩余顶点的 2%（DecUpdateCC），分量随之碎裂，删空后按相反顺序恢复（IncUpdateCC）。
+// 分别用路由表与逐棵树线性查找定位顶点所在的树，报告每个删除/恢复顶点的平均更新耗时。
+void runEttBench(const std::string& inputFile, int readMode, int walks, ConnectivityGraph conn) {
+    DancingMatrix dm(inputFile, readMode, false, true, conn);
+    auto& comps = dm.components;
+    if (comps.empty()) return;
+
+    // 按行数取最大分量，两种连通图选中同一分量
+    auto rowCount = [&](const splaytree::EulerTourTree& t) {
+        return std::count_if(t.vertices.begin(), t.vertices.end(), [&](int v) { return v < dm.ROWS; });
+    };
+    size_t largest = 0;
+    for (size_t i = 1; i < comps.size(); i++) {
+        if (rowCount(*comps[i]) > rowCount(*comps[largest])) largest = i;
+    }
+    std::vector<std::unique_ptr<splaytree::EulerTourTree>> stash;
+    stash.swap(comps);
+    comps.push_back(std::move(stash[largest]));
+    dm.activeSubgraph_ = dm.graph->subgraphOf(comps[0]->getAnyVertex());
+
+    // 只删除行；二分图模式下列顶点由 DecUpdateCC 随行删除
+    const size_t startSize = comps[0]->vertices.size();
+    std::vector<int> startRows;
+    for (int v : comps[0]->vertices) {
+        if (v < dm.ROWS) startRows.push_back(v);
+    }
+    std::sort(startRows.begin(), startRows.end());
+    std::cout << "实例: " << inputFile << ", 最大连通分量 " << startRows.size() << " 行 / " << startSize << " 个顶点, "
+              << walks << " 次随机下降" << std::endl;
+
+    auto run = [&](bool byIndex) {
+        dm.routeByIndex = byIndex;
+        std::mt19937_64 rng(1);
+
+        PoolStats nodesBefore = ObjectPool<splaytree::Node>::stats();
+        PoolStats treesBefore = ObjectPool<splaytree::EulerTourTree, 64>::stats();
+
+        double decNs = 0, incNs = 0;
+        uint64_t decAllocs = 0, incAllocs = 0;
+        size_t vertices = 0, steps = 0, compSum = 0, maxComps = 0;
+        bool restored = true;
+        for (int w = 0; w < walks; w++) {
+            std::vector<std::set<int>> trail;
+            std::vector<int> alive = startRows;
+            std::shuffle(alive.begin(), alive.end(), rng);
+            const size_t batch = std::max<size_t>(1, alive.size() / 50);
+            while (!alive.empty()) {
+                std::set<int> deleted;
+                for (size_t k = 0; k < batch && !alive.empty(); k++) {
+                    deleted.insert(alive.back());
+                    alive.pop_back();
+                }
+
+                uint64_t allocsBefore = heapAllocations;
+                auto start = std::chrono::high_resolution_clock::now();
+                dm.DecUpdateCC(deleted);
+                decNs += std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+                decAllocs += heapAllocations - allocsBefore;
+
+                vertices += deleted.size();
+                steps++;
+                compSum += comps.size();
+                maxComps = std::max(maxComps, comps.size());
+                trail.push_back(std::move(deleted));
+            }
+            for (auto it = trail.rbegin(); it != trail.rend(); ++it) {
+                uint64_t allocsBefore = heapAllocations;
+                auto start = std::chrono::high_resolution_clock::now();
+                dm.IncUpdateCC(*it);
+                incNs += std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+                incAllocs += heapAllocations - allocsBefore;
+            }
+            restored = restored && comps.size() == 1 && comps[0]->vertices.size() == startSize;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << (byIndex ? "路由表  " : "线性查找")
+                  << "  删除 " << std::setw(9) << decNs / std::max<size_t>(vertices, 1) << " ns/顶点"
+                  << "  恢复 " << std::setw(9) << incNs / std::max<size_t>(vertices, 1) << " ns/顶点"
+                  << "  平均分量数 " << std::setprecision(2) << double(compSum) / std::max<size_t>(steps, 1)
+                  << "  最大分量数 " << maxComps
+                  << (restored ? "" : "  (恢复后分量不一致)") << std::endl;
+
+        // 对象请求为经对象池的 Node 与 EulerTourTree 的 operator new 次数，新内存块为对象池向堆申请内存块的次数；
+        // 堆分配为 DecUpdateCC / IncUpdateCC 期间全局 operator new 的实际调用次数，含容器与临时对象
+        PoolStats nodes = ObjectPool<splaytree::Node>::stats();
+        PoolStats trees = ObjectPool<splaytree::EulerTourTree, 64>::stats();
+        std::cout << "          节点 对象请求 " << nodes.requests - nodesBefore.requests
+                  << " 新内存块 " << nodes.heapAllocs - nodesBefore.heapAllocs
+                  << "  树 对象请求 " << trees.requests - treesBefore.requests
+                  << " 新内存块 " << trees.heapAllocs - treesBefore.heapAllocs << std::endl;
+        std::cout << "          堆分配 删除 " << decAllocs << " 次 (" << double(decAllocs) / std::max<size_t>(vertices, 1)
+                  << "/顶点)  恢复 " << incAllocs << " 次 (" << double(incAllocs) / std::max<size_t>(vertices, 1) << "/顶点)" << std::endl;
+        return decNs + incNs;
+    };
+
+    double linear = run(false);
+    double indexed = run(true);
+    std::cout << std::fixed << std::setprecision(2) << "加速比: " << (indexed > 0 ? linear / indexed : 0.0) << "x" << std::endl;
+}
+
+// ./main <algorithm> <input> <read_mode> [ett] [pool_size] [--cache=verified|fingerprint] [--cache-mem=<size>] [--conn=clique|bipartite]
+// ./main convert <input> <read_mode> [output]
+// ./main buildbench <input> <read_mode> [repeat]
+// ./main cachebench <num_keys> <max_threads> [ops_per_thread] [--cache=...]
+// ./main query <circuit.bin> <conditions|-> [marginals_out]
+// ./main countbench <circuit.bin|-> <repeat> [instance read_mode] [--conn=...] [--cache=...] [--cache-mem=<size>]
+// ./main ettbench <input> <read_mode> [walks] [--conn=clique|bipartite]
 int main(int argc, char *argv[]){
     
+    SolverOptions options;
+    try {
+        argc = extractOptions(argc, argv, options);
+    } catch (const std::exception& e) {
+        std::cerr << "错误：" << e.what() << '\n';
+        return 1;
+    }
+
     if (argc < 4) {
             std::cout << "Usage: " << argv[0] << "<algorithm> <input> <read_mode>" << std::endl;
             return 1;
@@ -31,7 +570,9 @@ int main(int argc, char *argv[]){
     {
         std::string algType = argv[1];
         std::string input_file = argv[2];
-        int read_mode = std::stoi(argv[3]);
+        algorithm_type type = parseAlgorithmType(algType);
+        options.resolveWeights(input_file);
+        int read_mode = (type == algorithm_type::query || type == algorithm_type::countbench) ? 0 : std::stoi(argv[3]);
         bool use_ett = false;
         if (argc > 4) {
             use_ett = std::string(argv[4]) == "ett";
@@ -41,13 +582,13 @@ int main(int argc, char *argv[]){
         bool debug = false;
 
         string filename = fs::path(input_file).stem().string();
-        algorithm_type type = parseAlgorithmType(algType);
         switch (type) {
 
             case algorithm_type::dxz:
                 {
                     logger.logLine("启用DXZ算法求解: " + filename);
                     DanceDNNF danceDNNF(input_file, read_mode, logger);
+                    options.configure(danceDNNF);
                     danceDNNF.runDXZ();
                     logger.logLine("DXZ算法求解结束: " + filename);
                     break;
@@ -56,12 +597,14 @@ int main(int argc, char *argv[]){
                 {
                     if (use_ett) {
                         logger.logLine("启用DXD算法求解: " + filename);
-                        DanceDNNF danceDNNF(input_file, read_mode, logger, false, true, 1, debug);
+                        DanceDNNF danceDNNF(input_file, read_mode, logger, false, true, 1, debug, options.connectivity);
+                        options.configure(danceDNNF);
                         danceDNNF.startDXD();
                         logger.logLine("DXD算法求解结束: " + filename);
                     } else {
                         logger.logLine("启用DXD算法求解: " + filename);
                         DanceDNNF danceDNNF(input_file, read_mode, logger, true, false, 1, debug);
+                        options.configure(danceDNNF);
                         danceDNNF.startDXD();
                         logger.logLine("DXD算法求解结束: " + filename);
                     }
@@ -71,18 +614,115 @@ int main(int argc, char *argv[]){
                 {
                     if (use_ett) {
                         logger.logLine("启用多线程DXD算法求解: " + filename);
-                        DanceDNNF danceDNNF(input_file, read_mode, logger, false, true, num_threads, debug);
+                        DanceDNNF danceDNNF(input_file, read_mode, logger, false, true, num_threads, debug, options.connectivity);
+                        options.configure(danceDNNF);
                         danceDNNF.startMultiThreadDXD();
                         logger.logLine("多线程DXD算法求解结束: " + filename);
                     } else {
                         logger.logLine("启用多线程DXD算法求解: " + filename);
                         DanceDNNF danceDNNF(input_file, read_mode, logger, true, false, num_threads, debug);
+                        options.configure(danceDNNF);
                         danceDNNF.startMultiThreadDXD();
                         logger.logLine("多线程DXD算法求解结束: " + filename);
                     }
                     break;
                 }
 
+            case algorithm_type::convert:
+                {
+                    // 文本实例 -> 二进制 CSR 实例，默认输出到同目录下的 .csr 文件
+                    std::string output_file = (argc > 4) ? std::string(argv[4])
+                        : (fs::path(input_file).parent_path() / (filename + ".csr")).string();
+                    SparseInstance inst = InstanceLoader::parseText(input_file, read_mode);
+                    InstanceLoader::writeBinary(inst, output_file);
+                    std::cout << "转换完成: " << input_file << " -> " << output_file
+                              << " (" << inst.rows << " 行, " << inst.cols << " 列, "
+                              << inst.nnz() << " 个非零元)" << std::endl;
+                    break;
+                }
+
+            case algorithm_type::buildbench:
+                {
+                    // 比较逐个有序插入与批量建立舞蹈链的耗时，并校验二者结构一致
+                    int repeat = (argc > 4) ? std::max(1, std::stoi(argv[4])) : 5;
+                    MappedFile file(input_file);
+                    SparseInstance parsed;
+                    CsrView csr;
+                    if (InstanceLoader::isBinary(file.data(), file.size())) {
+                        csr = InstanceLoader::viewBinary(file.data(), file.size());
+                    } else {
+                        parsed = InstanceLoader::parseBuffer(file.data(), file.data() + file.size(), read_mode);
+                        csr = parsed.view();
+                    }
+
+                    auto build = [&](bool bulk, DlxArena& dlx) {
+                        std::vector<int> colSize(csr.cols + 1, 0), rowSize(csr.rows, 0);
+                        std::vector<DlxArena::index_t> rowHead(csr.rows, 0);
+                        auto start = std::chrono::high_resolution_clock::now();
+                        DlxBuilder::initHeaders(dlx, csr.cols, csr.nnz);
+                        if (bulk) {
+                            DlxBuilder::linkBulk(dlx, csr, colSize.data(), rowSize.data(), rowHead.data());
+                        } else {
+                            for (int r = 0; r < csr.rows; r++) {
+                                for (uint32_t k = csr.rowOffsets[r]; k < csr.rowOffsets[r + 1]; k++) {
+                                    DlxBuilder::insertSorted(dlx, colSize.data(), rowSize.data(),
+                                                             rowHead.data(), r, csr.colIndices[k]);
+                                }
+                            }
+                        }
+                        return std::chrono::duration<double, std::milli>(
+                            std::chrono::high_resolution_clock::now() - start).count();
+                    };
+
+                    double bestInsert = 1e300, bestBulk = 1e300;
+                    bool same = true;
+                    for (int i = 0; i < repeat; i++) {
+                        DlxArena sortedDlx, bulkDlx;
+                        bestInsert = std::min(bestInsert, build(false, sortedDlx));
+                        bestBulk = std::min(bestBulk, build(true, bulkDlx));
+                        same = same && DlxBuilder::sameStructure(sortedDlx, bulkDlx);
+                    }
+
+                    std::cout << std::fixed << std::setprecision(3)
+                              << "实例: " << filename << " (" << csr.rows << " 行, " << csr.cols
+                              << " 列, " << csr.nnz << " 个非零元), 重复 " << repeat << " 次取最小值" << std::endl
+                              << "有序插入: " << bestInsert << " ms" << std::endl
+                              << "批量建立: " << bestBulk << " ms" << std::endl
+                              << "加速比: " << (bestBulk > 0 ? bestInsert / bestBulk : 0.0) << "x" << std::endl
+                              << "结构一致: " << (same ? "是" : "否") << std::endl;
+                    if (!same) return 1;
+                    break;
+                }
+
+            case algorithm_type::cachebench:
+                {
+                    int numKeys = std::max(1, std::stoi(argv[2]));
+                    int maxThreads = std::max(1, std::stoi(argv[3]));
+                    long opsPerThread = (argc > 4) ? std::stol(argv[4]) : 1000000;
+                    runCacheBench(numKeys, maxThreads, opsPerThread, options.cacheMode);
+                    break;
+                }
+
+            case algorithm_type::ettbench:
+                {
+                    runEttBench(input_file, read_mode, (argc > 4) ? std::max(1, std::stoi(argv[4])) : 3, options.connectivity);
+                    break;
+                }
+
+            case algorithm_type::countbench:
+                {
+                    int repeat = std::max(1, std::stoi(argv[3]));
+                    if (argc > 5) runSolverCountBench(argv[4], std::stoi(argv[5]), repeat, options);
+                    runCountBench(input_file, repeat);
+                    break;
+                }
+
+            case algorithm_type::query:
+                {
+                    runQuery(input_file, argv[3], (argc > 4) ? std::string(argv[4]) : "", options);
+                    break;
+                }
+
             default:
                 std::cout << "Unknowed algorithm type" << std::endl;
                 return 1;
@@ -0,0 +1,969 @@
+// 单元测试：每个 test* 函数覆盖一个模块，失败时打印位置并以非零状态退出
+// cd build && ./unit_tests 或 ctest --output-on-failure
+#include "../include/Block.h"
+#include "../include/CountCache.h"
+#include "../include/DXD.h"
+#include "../include/DnnfEnumerator.h"
+#include "../include/DnnfQuery.h"
+#include "../include/DnnfSampler.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " #cond << std::endl; \
+            failures++;                                                               \
+        }                                                                             \
+    } while (0)
+
+// 列号不连续的块：0..maxCol 中不属于块的列不能进入队列，对它们的更新不影响块内的列
+static void testColumnBucketsSparseColumns() {
+    SparseSet cols(std::vector<int>{3, 17, 42});
+    std::vector<int> colSize(43, 0);
+    colSize[3] = 4;
+    colSize[17] = 2;
+    colSize[42] = 3;
+
+    ColumnBuckets q;
+    q.build(cols, colSize.data());
+    CHECK(q.top() == 17);
+
+    // 块外的列：更新被忽略，也不会成为最小列
+    for (int c : {0, 1, 5, 16, 41, 43, 1000, -1}) {
+        q.decrease(c);
+        q.remove(c);
+        q.restore(c);
+        q.increase(c);
+    }
+    CHECK(q.top() == 17);
+
+    q.remove(17);
+    CHECK(q.top() == 42);
+    q.decrease(3);
+    q.decrease(3);
+    CHECK(q.top() == 3);   // 3 与 42 的桶已分离，3 的大小降到 2
+    q.restore(17);
+    CHECK(q.top() == 3);   // 同为大小 2，3 先进入桶
+    q.remove(3);
+    q.remove(17);
+    q.remove(42);
+    CHECK(q.top() == -1);
+}
+
+// 带预算的缓存在反复淘汰后，实际占用（数组容量、失效键与索引开销）不超过预算
+static void testCountCacheBudgetAfterChurn() {
+    const size_t budget = 256 * 1024;
+    std::mt19937_64 rng(7);
+    for (size_t shards : {size_t(1), size_t(8)}) {
+        CountCache cache(CacheMode::Verified, shards);
+        cache.setBudget(budget);
+        for (int i = 0; i < 50000; i++) {
+            // 键长在几字节到几百字节之间变化，制造大量失效键
+            std::vector<int> cols;
+            int n = 1 + static_cast<int>(rng() % 200);
+            for (int k = 0; k < n; k++) cols.push_back(1 + static_cast<int>(rng() % 4000));
+            std::sort(cols.begin(), cols.end());
+            cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+            cache.insert(rng(), SparseSet(cols), DNNFResult(i), 0);
+            if (i % 1000 == 0) CHECK(cache.memoryBytes() <= budget);
+        }
+        CHECK(cache.memoryBytes() <= budget);
+        CHECK(cache.evictions() > 0);
+        CHECK(cache.entries() > 0);
+
+        // 最近写入的条目可以命中
+        std::vector<int> cols{1, 2, 3};
+        cache.insert(42, SparseSet(cols), DNNFResult(5), 9);
+        DNNFResult value;
+        dnnf_id node = 0;
+        CHECK(cache.lookup(42, SparseSet(cols), value, node) && value == DNNFResult(5) && node == 9);
+
+        // 调小预算后立即降到新预算以内，之后仍可写入
+        cache.setBudget(budget / 4);
+        CHECK(cache.memoryBytes() <= budget / 4);
+        cache.insert(43, SparseSet(cols), DNNFResult(6), 0);
+        CHECK(cache.memoryBytes() <= budget / 4);
+        CHECK(cache.lookup(43, SparseSet(cols), value, node) && value == DNNFResult(6));
+    }
+}
+
+// 两个不同的列集合落在同一个哈希上：Verified 模式比较规范化键，各自保存、互不顶替；
+// Fingerprint 模式只比较哈希，后写入的值覆盖先写入的，查另一个集合会拿到错误的计数
+static void testCountCacheHashCollision() {
+    const uint64_t hash = 0x9e3779b97f4a7c15ull;
+    std::vector<int> colsA{1, 4, 9}, colsB{2, 4, 8, 16};
+    DNNFResult value;
+    dnnf_id node = 0;
+
+    for (size_t budget : {size_t(0), size_t(64 * 1024)}) {
+        CountCache cache(CacheMode::Verified);
+        cache.setBudget(budget);
+        cache.insert(hash, SparseSet(colsA), DNNFResult(11), 1);
+        CHECK(!cache.lookup(hash, SparseSet(colsB), value, node));
+        CHECK(cache.collisions() == 1);
+
+        cache.insert(hash, SparseSet(colsB), DNNFResult(22), 2);
+        CHECK(cache.entries() == 2);
+        CHECK(cache.lookup(hash, SparseSet(colsA), value, node) && value == DNNFResult(11) && node == 1);
+        CHECK(cache.lookup(hash, SparseSet(colsB), value, node) && value == DNNFResult(22) && node == 2);
+
+        // 覆盖其中一个不影响另一个
+        cache.insert(hash, SparseSet(colsA), DNNFResult(33), 3);
+        CHECK(cache.entries() == 2);
+        CHECK(cache.lookup(hash, SparseSet(colsA), value, node) && value == DNNFResult(33) && node == 3);
+        CHECK(cache.lookup(hash, SparseSet(colsB), value, node) && value == DNNFResult(22) && node == 2);
+    }
+
+    CountCache fingerprint(CacheMode::Fingerprint);
+    fingerprint.insert(hash, SparseSet(colsA), DNNFResult(11), 1);
+    CHECK(fingerprint.lookup(hash, SparseSet(colsB), value, node) && value == DNNFResult(11));
+    fingerprint.insert(hash, SparseSet(colsB), DNNFResult(22), 2);
+    CHECK(fingerprint.entries() == 1);
+    CHECK(fingerprint.lookup(hash, SparseSet(colsA), value, node) && value == DNNFResult(22) && node == 2);
+    CHECK(fingerprint.collisions() == 0);
+}
+
+static DNNFResult pow2(size_t k) {
+    DNNFResult r(1);
+    for (size_t i = 0; i < k; i++) r = r * DNNFResult(2);
+    return r;
+}
+
+// 按标准 d-DNNF 语义数 .nnf 文件的模型数（变量未出现即不受约束）：
+// O 节点的各子电路按变量集合之差补乘 2 的幂，根节点按电路外的变量数补乘；AND 的子电路须互不相交
+static DNNFResult countNnfModels(const std::string& path, bool& decomposable) {
+    std::ifstream in(path);
+    std::string tag;
+    size_t nodes = 0, edges = 0;
+    int numVars = 0;
+    in >> tag >> nodes >> edges >> numVars;
+
+    std::vector<DNNFResult> count(nodes);
+    std::vector<std::vector<int>> scope(nodes);
+    decomposable = true;
+    for (size_t i = 0; i < nodes; i++) {
+        in >> tag;
+        if (tag == "L") {
+            int l;
+            in >> l;
+            count[i] = DNNFResult(1);
+            scope[i] = {std::abs(l)};
+            continue;
+        }
+
+        size_t k;
+        if (tag == "O") in >> k;  // 决策变量
+        in >> k;
+        std::vector<size_t> children(k);
+        for (size_t& c : children) in >> c;
+
+        std::vector<int>& vars = scope[i];
+        for (size_t c : children) vars.insert(vars.end(), scope[c].begin(), scope[c].end());
+        std::sort(vars.begin(), vars.end());
+        size_t total = vars.size();
+        vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+
+        if (tag == "A") {
+            decomposable = decomposable && total == vars.size();
+            count[i] = DNNFResult(1);
+            for (size_t c : children) count[i] = count[i] * count[c];
+        } else {
+            count[i] = DNNFResult(0);
+            for (size_t c : children) count[i] = count[i] + count[c] * pow2(vars.size() - scope[c].size());
+        }
+    }
+    return count[nodes - 1] * pow2(numVars - scope[nodes - 1].size());
+}
+
+// 导出的 .nnf 按标准 d-DNNF 语义的模型数等于求解器的解数
+static void testExportedNnfModelCount() {
+    struct Case { const char* file; int mode; };
+    const Case cases[] = {
+        {"exact_cover_benchmark/bell-03.ec", 1},
+        {"exact_cover_benchmark/bell-06.ec", 1},
+        {"exact_cover_benchmark/doublefact-05.ec", 1},
+        {"exact_cover_benchmark/latin6-blk-00001.ec", 1},
+        {"run_set/Arnes.txt", 3},  // 含 AND 节点
+    };
+    std::string nnf = (fs::temp_directory_path() / "dxd_unit_test.nnf").string();
+    Logger logger("/dev/null", false);
+    for (const Case& c : cases) {
+        DanceDNNF solver(std::string(DXD_SOURCE_DIR "/data/") + c.file, c.mode, logger, false, true);
+        solver.setExportPaths(nnf, "");
+        solver.startDXD();
+
+        bool decomposable = false;
+        DNNFResult models = countNnfModels(nnf, decomposable);
+        CHECK(decomposable);
+        CHECK(models.toString() == solver.solutionCount);
+        if (models.toString() != solver.solutionCount) {
+            std::cerr << c.file << ": 模型数 " << models.toString() << ", 解数 " << solver.solutionCount << std::endl;
+        }
+    }
+    fs::remove(nnf);
+}
+
+// 在半环中搜索的结果与在编译后电路上按同一半环求值的结果一致
+static void testSemiringSearchMatchesCircuit() {
+    const std::string instance = DXD_SOURCE_DIR "/data/run_set/Bellcanada.txt";  // 含 AND 节点
+    std::string weightsPath = (fs::temp_directory_path() / "dxd_unit_test.weights").string();
+    Logger logger("/dev/null", false);
+
+    int rows = 0;
+    {
+        SparseInstance inst = InstanceLoader::parseText(instance, 3);
+        rows = inst.rows;
+        std::mt19937_64 rng(3);
+        std::ofstream out(weightsPath);
+        for (int r = 1; r <= rows; r++) {
+            if (rng() % 4) out << r << ' ' << 0.25 + double(rng() % 1000) / 500.0 << '\n';
+        }
+    }
+    RowWeights weights = RowWeights::load(weightsPath, rows);
+
+    for (const char* name : {"count", "mod", "log", "sum", "maxprod", "minsum"}) {
+        for (bool parallel : {false, true}) {
+            DanceDNNF solver(instance, 3, logger, false, true, parallel ? 4 : 1);
+            solver.setSemiring(name, weightsPath);
+            if (parallel) solver.startMultiThreadDXD();
+            else solver.startDXD();
+
+            std::string expected = evaluateCircuitByName(name, solver.getStore(), solver.getRoot(), weights);
+            CHECK(solver.getSemiringValue() == expected);
+            CHECK(solver.solutionCount == "775");
+            if (solver.getSemiringValue() != expected) {
+                std::cerr << name << (parallel ? " (mdxd)" : "") << ": 搜索 " << solver.getSemiringValue()
+                          << ", 电路 " << expected << std::endl;
+            }
+        }
+    }
+    fs::remove(weightsPath);
+}
+
+// 由十进制串构造，只用加法与乘法
+static BigCount bigFromDecimal(const std::string& digits) {
+    BigCount v(0);
+    for (char ch : digits) v = v * BigCount(10) + BigCount(static_cast<uint64_t>(ch - '0'));
+    return v;
+}
+
+static BigCount bigPow(uint64_t base, int exponent) {
+    BigCount v(1);
+    for (int i = 0; i < exponent; i++) v *= BigCount(base);
+    return v;
+}
+
+static void testBigCountArithmetic() {
+    // 十进制输出
+    CHECK(BigCount().toString() == "0");
+    CHECK(BigCount(0) * bigPow(2, 100) == BigCount(0));
+    CHECK((BigCount(0) * bigPow(2, 100)).fitsU64());
+    CHECK(BigCount(UINT64_MAX).toString() == "18446744073709551615");
+
+    // 加法进位跨过 limb 边界
+    BigCount a(UINT64_MAX);
+    a += BigCount(1);
+    CHECK(!a.fitsU64() && a.limbCount() == 2);
+    CHECK(a.toString() == "18446744073709551616");
+    BigCount allOnes = bigPow(2, 192) - BigCount(1);  // 三个全 1 的 limb
+    CHECK(allOnes.limbCount() == 3);
+    allOnes += BigCount(1);                          // 进位连续穿过三个 limb
+    CHECK(allOnes.limbCount() == 4);
+    CHECK(allOnes == bigPow(2, 192));
+    CHECK(allOnes.toString() == "6277101735386680763835789423207666416102355444464034512896");
+
+    // 乘法超出 64 位
+    BigCount p(UINT64_MAX);
+    p *= BigCount(UINT64_MAX);
+    CHECK(p.toString() == "340282366920938463426481119284349108225");
+    CHECK((BigCount(uint64_t(1) << 32) * BigCount(uint64_t(1) << 32)).toString() == "18446744073709551616");
+    p *= p;  // 自乘
+    CHECK(p == bigFromDecimal("115792089237316195398462578067141184799968521174335529155754622898352762650625"));
+
+    // 大于 2^128 的十进制输出
+    CHECK(bigPow(2, 128).toString() == "340282366920938463463374607431768211456");
+    CHECK(bigPow(2, 200).toString() == "1606938044258990275541962092341162602522202993782792835301376");
+    CHECK(bigPow(10, 40).toString() == "1" + std::string(40, '0'));
+    CHECK(bigPow(10, 40) - BigCount(1) == bigFromDecimal(std::string(40, '9')));
+
+    // 减法借位后退回内联表示
+    BigCount back = bigPow(2, 64) + BigCount(5);
+    back -= bigPow(2, 64);
+    CHECK(back.fitsU64() && back.low() == 5);
+}
+
+// 随机的加法与乘法序列：精确计数与多模数计数经中国剩余定理还原的结果一致（值在精确范围内）
+static void testBigCountAgreesWithModCount() {
+    // 乘数不超过 2^64，乘之前值低于 2^(BOUND_BITS-64) 即可保证结果仍在精确范围内
+    const BigCount mulLimit = bigPow(2, ModCount::rep_type::BOUND_BITS - 64);
+    std::mt19937_64 rng(11);
+    int wide = 0;
+    for (int round = 0; round < 200; round++) {
+        BigCount exact(1);
+        ModCount mod(1);
+        for (int step = 0; step < 12; step++) {
+            uint64_t x = rng() >> (rng() % 64);
+            if (rng() % 2 && exact < mulLimit) {
+                exact *= BigCount(x);
+                mod *= ModCount(x);
+            } else {
+                exact += BigCount(x);
+                mod += ModCount(x);
+            }
+        }
+        CHECK(exact.toString() == mod.toString());
+        if (!exact.fitsU64()) wide++;
+    }
+    CHECK(wide > 100);
+}
+
+// 基准实例上精确计数与多模数计数得到相同的解数；bell03-x40 为 40 个独立的 bell-03，解数 5^40 超出 64 位
+static void testExactAndModularSearchAgree() {
+    struct Case { const char* file; int mode; const char* count; };
+    const Case cases[] = {
+        {"exact_cover_benchmark/bell-10.txt", 1, "115975"},
+        {"run_set/Aarnet.txt", 3, "53067357700"},
+        {"regression/bell03-x40.ec", 1, "9094947017729282379150390625"},
+    };
+    Logger logger("/dev/null", false);
+    for (const Case& c : cases) {
+        for (CountMode mode : {CountMode::Exact, CountMode::Modular}) {
+            DanceDNNF solver(std::string(DXD_SOURCE_DIR "/data/") + c.file, c.mode, logger, false, true);
+            solver.setCountMode(mode);
+            solver.startDXD();
+            CHECK(solver.solutionCount == c.count);
+            if (solver.solutionCount != c.count) {
+                std::cerr << c.file << (mode == CountMode::Modular ? " (mod)" : "") << ": " << solver.solutionCount << std::endl;
+            }
+        }
+    }
+}
+
+template <typename F>
+static bool throwsRuntimeError(F f) {
+    try {
+        f();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// 损坏的二进制实例（截断、偏移越界、列号越界、列索引与行数据不一致）在建立视图时被拒绝
+static void testBinaryInstanceValidation() {
+    SparseInstance inst = InstanceLoader::parseText(DXD_SOURCE_DIR "/data/exact_cover_benchmark/bell-06.ec", 1);
+    std::string path = (fs::temp_directory_path() / "dxd_unit_test.csr").string();
+    InstanceLoader::writeBinary(inst, path);
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    fs::remove(path);
+
+    const size_t rowOffsetsAt = sizeof(BinaryInstanceHeader);
+    const size_t colIndicesAt = rowOffsetsAt + (inst.rows + 1) * sizeof(uint32_t);
+    const size_t colOffsetsAt = colIndicesAt + inst.nnz() * sizeof(int32_t);
+    const size_t colRowsAt = colOffsetsAt + (inst.cols + 2) * sizeof(uint32_t);
+    CHECK(good.size() == colRowsAt + inst.nnz() * sizeof(int32_t));
+
+    auto view = [](const std::string& bytes) { return InstanceLoader::viewBinary(bytes.data(), bytes.size()); };
+    auto patched = [&](size_t offset, uint32_t value) {
+        std::string bytes = good;
+        std::memcpy(&bytes[offset], &value, sizeof(value));
+        return bytes;
+    };
+
+    CsrView v = view(good);
+    CHECK(v.rows == inst.rows && v.nnz == inst.nnz() && v.hasColumnIndex());
+
+    // 截断
+    CHECK(throwsRuntimeError([&] { view(good.substr(0, good.size() - 4)); }));
+    CHECK(throwsRuntimeError([&] { view(good.substr(0, colIndicesAt)); }));
+    // 行偏移：中间越过 nnz、不单调、结尾不等于 nnz
+    CHECK(throwsRuntimeError([&] { view(patched(rowOffsetsAt + 4, uint32_t(inst.nnz() + 1))); }));
+    CHECK(throwsRuntimeError([&] { view(patched(rowOffsetsAt + 8, 0)); }));
+    CHECK(throwsRuntimeError([&] { view(patched(rowOffsetsAt + inst.rows * 4, uint32_t(inst.nnz() - 1))); }));
+    // 列号越界
+    CHECK(throwsRuntimeError([&] { view(patched(colIndicesAt, uint32_t(inst.cols + 1))); }));
+    CHECK(throwsRuntimeError([&] { view(patched(colIndicesAt, 0)); }));
+    // 列偏移越界，列索引中的行号越界或指向不含该列的行
+    CHECK(throwsRuntimeError([&] { view(patched(colOffsetsAt + 8, uint32_t(inst.nnz() + 1))); }));
+    CHECK(throwsRuntimeError([&] { view(patched(colRowsAt, uint32_t(inst.rows))); }));
+    int32_t firstRow = 0;
+    std::memcpy(&firstRow, &good[colRowsAt], sizeof(firstRow));
+    int wrongRow = firstRow;
+    for (int r = 0; r < inst.rows && wrongRow == firstRow; r++) {
+        const int32_t* b = inst.colIndices.data() + inst.rowOffsets[r];
+        const int32_t* e = inst.colIndices.data() + inst.rowOffsets[r + 1];
+        if (!std::binary_search(b, e, 1)) wrongRow = r;
+    }
+    CHECK(wrongRow != firstRow);
+    CHECK(throwsRuntimeError([&] { view(patched(colRowsAt, uint32_t(wrongRow))); }));
+}
+
+// 二进制 d-DNNF：0、1 号记录不是终端节点、决策行号越界或文件截断时拒绝载入
+static void testDnnfBinaryValidation() {
+    std::string path = (fs::temp_directory_path() / "dxd_unit_test.dnnf").string();
+    Logger logger("/dev/null", false);
+    std::string count;
+    {
+        DanceDNNF solver(DXD_SOURCE_DIR "/data/run_set/Arnes.txt", 3, logger, false, true);
+        solver.setExportPaths("", path);
+        solver.startDXD();
+        count = solver.solutionCount;
+    }
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    BinaryDnnfHeader header;
+    std::memcpy(&header, good.data(), sizeof(header));
+    const size_t recordsAt = sizeof(BinaryDnnfHeader);
+
+    DnnfStore store;
+    int numVars = 0;
+    dnnf_id root = store.readBinary(path, numVars);
+    CHECK(numVars == static_cast<int>(header.numVars));
+    CHECK(evaluateCircuit<CountSemiring>(store, root, RowWeights(numVars)).toString() == count);
+
+    auto rejects = [&](const std::string& bytes) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), bytes.size());
+        }
+        int vars = 0;
+        bool threw = throwsRuntimeError([&] { store.readBinary(path, vars); });
+        return threw && store.size() == 2;
+    };
+    auto patched = [&](size_t offset, const void* value, size_t n) {
+        std::string bytes = good;
+        std::memcpy(&bytes[offset], value, n);
+        return bytes;
+    };
+
+    // 0 号记为决策节点、1 号记为 AND 节点
+    DnnfKind decision = DnnfKind::Decision, conj = DnnfKind::And;
+    CHECK(rejects(patched(recordsAt, &decision, 1)));
+    CHECK(rejects(patched(recordsAt + sizeof(DnnfNodeRecord), &conj, 1)));
+
+    // 决策行号等于 numVars 或为负
+    size_t decisionAt = 0;
+    for (dnnf_id id = 2; id < header.nodeCount && !decisionAt; id++) {
+        DnnfNodeRecord rec;
+        std::memcpy(&rec, &good[recordsAt + id * sizeof(rec)], sizeof(rec));
+        if (rec.kind == DnnfKind::Decision) decisionAt = recordsAt + id * sizeof(rec);
+    }
+    CHECK(decisionAt > 0);
+    int32_t label = static_cast<int32_t>(header.numVars);
+    CHECK(rejects(patched(decisionAt + offsetof(DnnfNodeRecord, label), &label, sizeof(label))));
+    label = -1;
+    CHECK(rejects(patched(decisionAt + offsetof(DnnfNodeRecord, label), &label, sizeof(label))));
+
+    // 截断
+    CHECK(rejects(good.substr(0, good.size() - 4)));
+    fs::remove(path);
+}
+
+// 求解并保留电路，供电路上的查询、抽样与枚举测试使用
+static std::unique_ptr<DanceDNNF> compileInstance(const std::string& path, int mode, Logger& logger) {
+    auto solver = std::make_unique<DanceDNNF>(path, mode, logger, false, true);
+    solver->startDXD();
+    return solver;
+}
+
+// 写出 blocks 个互不相交的 bell-03（每块 3 列 7 行），linked 时再用一列把它们连起来：
+// 行 {L} 单独覆盖连接列 L，另有每块一行 {L, 该块第 1 列}。选 {L} 时各块独立，各 5 个解；
+// 选第 k 块的连接行时该块剩 2 个解，其余块各 5 个。解数为 5^(blocks-1) * (5 + 2 * blocks)，
+// 整个实例连通，电路的根是一条覆盖全部解的决策链。不连接时根为 AND 节点，解数为 5^blocks
+static void writeLinkedBell03(const std::string& path, int blocks, bool linked = true) {
+    const std::vector<std::vector<int>> bell03{{1}, {2}, {1, 2}, {3}, {1, 3}, {2, 3}, {1, 2, 3}};
+    const int link = 3 * blocks + 1;
+    std::ofstream out(path);
+    if (!linked) {
+        out << "c n = " << 3 * blocks << ", m = " << 7 * blocks << "\n";
+        out << "p ec " << 3 * blocks << "\n";
+    } else {
+        out << "c n = " << link << ", m = " << 8 * blocks + 1 << "\n";
+        out << "p ec " << link << "\n";
+    }
+    for (int b = 0; b < blocks; b++) {
+        for (const auto& row : bell03) {
+            out << "s";
+            for (int c : row) out << ' ' << 3 * b + c;
+            out << "\n";
+        }
+    }
+    if (!linked) return;
+    out << "s " << link << "\n";
+    for (int b = 0; b < blocks; b++) out << "s " << 3 * b + 1 << ' ' << link << "\n";
+}
+
+// rows（从 0 开始）恰好覆盖每列一次
+static bool isExactCover(const SparseInstance& inst, const std::vector<int>& rows) {
+    std::vector<int> covered(static_cast<size_t>(inst.cols) + 1, 0);
+    for (int r : rows) {
+        if (r < 0 || r >= inst.rows) return false;
+        for (uint32_t k = inst.rowOffsets[r]; k < inst.rowOffsets[r + 1]; k++) covered[inst.colIndices[k]]++;
+    }
+    return std::all_of(covered.begin() + 1, covered.end(), [](int n) { return n == 1; });
+}
+
+// 枚举电路的全部解，每个解的行号升序
+static std::vector<std::vector<int>> allSolutions(const DnnfStore& store, dnnf_id root) {
+    std::vector<std::vector<int>> solutions;
+    DnnfEnumerator(store, root).forEach([&](const std::vector<int>& rows) {
+        solutions.push_back(rows);
+        std::sort(solutions.back().begin(), solutions.back().end());
+    });
+    return solutions;
+}
+
+// 电路查询与对枚举结果的逐个统计一致：总数、混合必选/禁选条件下的解数（含同一行既必选又禁选）与每一行的边际计数
+static void testDnnfQueryMatchesEnumeration() {
+    std::string linked = (fs::temp_directory_path() / "dxd_unit_test_linked.ec").string();
+    writeLinkedBell03(linked, 3);
+    struct Case { std::string file; int mode; };
+    const Case cases[] = {
+        {DXD_SOURCE_DIR "/data/run_set/Bellcanada.txt", 3},  // 含 AND 节点
+        {linked, 1},                                        // 根为决策链，选中后分解为 AND
+        {DXD_SOURCE_DIR "/data/exact_cover_benchmark/bell-06.ec", 1},
+    };
+    Logger logger("/dev/null", false);
+    std::mt19937_64 rng(5);
+    for (const Case& c : cases) {
+        auto solver = compileInstance(c.file, c.mode, logger);
+        SparseInstance inst = InstanceLoader::parseText(c.file, c.mode);
+        DnnfQuery query(solver->getStore(), solver->getRoot(), inst.rows);
+        std::vector<std::vector<int>> solutions = allSolutions(solver->getStore(), solver->getRoot());
+
+        CHECK(query.count().toString() == solver->solutionCount);
+        CHECK(std::to_string(solutions.size()) == solver->solutionCount);
+
+        // 边际计数
+        std::vector<uint64_t> expected(inst.rows, 0);
+        for (const auto& s : solutions) {
+            for (int r : s) expected[r]++;
+        }
+        std::vector<DNNFResult> marginals = query.marginals();
+        CHECK(marginals.size() == expected.size());
+        size_t wrong = 0;
+        for (int r = 0; r < inst.rows && r < static_cast<int>(marginals.size()); r++) {
+            if (marginals[r] != DNNFResult(expected[r])) wrong++;
+        }
+        CHECK(wrong == 0);
+
+        // 条件计数：必选行多取自某个解，使结果多为非零；禁选行随机取
+        auto bruteForce = [&](const std::vector<int>& forced, const std::vector<int>& forbidden) {
+            uint64_t n = 0;
+            for (const auto& s : solutions) {
+                bool ok = std::all_of(forced.begin(), forced.end(),
+                                      [&](int r) { return std::binary_search(s.begin(), s.end(), r); }) &&
+                          std::none_of(forbidden.begin(), forbidden.end(),
+                                       [&](int r) { return std::binary_search(s.begin(), s.end(), r); });
+                n += ok;
+            }
+            return DNNFResult(n);
+        };
+        for (int trial = 0; trial < 200; trial++) {
+            const auto& s = solutions[rng() % solutions.size()];
+            std::vector<int> forced, forbidden;
+            for (size_t k = 0, n = rng() % 4; k < n; k++) {
+                forced.push_back(rng() % 3 ? s[rng() % s.size()] : static_cast<int>(rng() % inst.rows));
+            }
+            for (size_t k = 0, n = rng() % 4; k < n; k++) forbidden.push_back(static_cast<int>(rng() % inst.rows));
+            if (trial % 10 == 0 && !forced.empty()) forbidden.push_back(forced[0]);  // 既必选又禁选
+            CHECK(query.conditionedCount(forced, forbidden) == bruteForce(forced, forbidden));
+        }
+        CHECK(query.conditionedCount({}, {}) == query.count());
+        CHECK(query.conditionedCount({solutions[0][0]}, {solutions[0][0]}).isZero());
+    }
+    fs::remove(linked);
+}
+
+// 观测频数相对期望频数的卡方统计量不超过 df + 5 * sqrt(2 df)（自由度较大时约为 p < 1e-5 的分位点）
+static bool passesChiSquare(const std::vector<uint64_t>& observed, const std::vector<double>& expected) {
+    double chi2 = 0;
+    for (size_t i = 0; i < observed.size(); i++) {
+        double d = double(observed[i]) - expected[i];
+        chi2 += d * d / expected[i];
+    }
+    double df = double(observed.size() - 1);
+    bool ok = chi2 <= df + 5 * std::sqrt(2 * df);
+    if (!ok) std::cerr << "卡方 " << chi2 << ", 自由度 " << df << std::endl;
+    return ok;
+}
+
+// 固定种子抽样：每个样本都是精确覆盖，各解的频数通过卡方检验；
+// 连接 40 块 bell-03 的实例根链解数超过 2^64，抽样走 BigCount::uniformBelow 的拒绝采样分支
+static void testDnnfSamplerUniform() {
+    Logger logger("/dev/null", false);
+    std::mt19937_64 rng(17);
+    std::vector<int> rows;
+
+    // 小实例：逐个解统计频数，每个解期望出现 40 次
+    {
+        const std::string file = DXD_SOURCE_DIR "/data/run_set/Bellcanada.txt";
+        auto solver = compileInstance(file, 3, logger);
+        SparseInstance inst = InstanceLoader::parseText(file, 3);
+        std::vector<std::vector<int>> solutions = allSolutions(solver->getStore(), solver->getRoot());
+        std::sort(solutions.begin(), solutions.end());
+
+        DnnfSampler sampler(solver->getStore(), solver->getRoot(), inst.rows);
+        CHECK(sampler.total() == DNNFResult(solutions.size()));
+        std::vector<uint64_t> observed(solutions.size(), 0);
+        size_t invalid = 0;
+        for (size_t i = 0; i < solutions.size() * 40; i++) {
+            CHECK(sampler.sample(rng, rows));
+            auto it = std::lower_bound(solutions.begin(), solutions.end(), rows);
+            if (it == solutions.end() || *it != rows || !isExactCover(inst, rows)) invalid++;
+            else observed[it - solutions.begin()]++;
+        }
+        CHECK(invalid == 0);
+        CHECK(passesChiSquare(observed, std::vector<double>(solutions.size(), 40.0)));
+    }
+
+    // 大实例：按选中的连接行分类，{L} 的概率为 5/85，每块的连接行为 2/85
+    {
+        const int blocks = 40;
+        std::string file = (fs::temp_directory_path() / "dxd_unit_test_linked40.ec").string();
+        writeLinkedBell03(file, blocks);
+        auto solver = compileInstance(file, 1, logger);
+        SparseInstance inst = InstanceLoader::parseText(file, 1);
+        fs::remove(file);
+
+        DnnfSampler sampler(solver->getStore(), solver->getRoot(), inst.rows);
+        DNNFResult total(17);
+        for (int i = 0; i < blocks; i++) total = total * DNNFResult(5);
+        CHECK(sampler.total() == total);
+        CHECK(!sampler.total().rep().fitsU64());
+        CHECK(solver->getStore().node(solver->getRoot()).kind == DnnfKind::Decision);
+
+        const int firstLinkRow = 7 * blocks;
+        const size_t n = 85 * 100;
+        std::vector<uint64_t> observed(blocks + 1, 0);
+        size_t invalid = 0;
+        for (size_t i = 0; i < n; i++) {
+            CHECK(sampler.sample(rng, rows));
+            int link = -1, links = 0;
+            for (int r : rows) {
+                if (r >= firstLinkRow) link = r - firstLinkRow, links++;
+            }
+            if (links != 1 || !isExactCover(inst, rows)) invalid++;
+            else observed[link]++;
+        }
+        CHECK(invalid == 0);
+        std::vector<double> expected(blocks + 1, n * 2.0 / 85);
+        expected[0] = n * 5.0 / 85;
+        CHECK(passesChiSquare(observed, expected));
+    }
+}
+
+// 枚举出的解数等于求解器的解数，解两两不同且都是精确覆盖；limit 截断与根为 FALSE/TRUE 的情形
+static void testDnnfEnumerator() {
+    std::string independent = (fs::temp_directory_path() / "dxd_unit_test_blocks.ec").string();
+    std::string linked = (fs::temp_directory_path() / "dxd_unit_test_linked.ec").string();
+    std::string unsat = (fs::temp_directory_path() / "dxd_unit_test_unsat.ec").string();
+    writeLinkedBell03(independent, 4, false);  // 根为 4 个分块的 AND，进位跨过 AND 帧
+    writeLinkedBell03(linked, 3);              // 决策链下嵌套 AND
+    {
+        std::ofstream out(unsat);
+        out << "c n = 3, m = 2\np ec 3\ns 1 2\ns 2 3\n";
+    }
+    struct Case { std::string file; int mode; const char* count; };
+    const Case cases[] = {
+        {independent, 1, "625"},
+        {linked, 1, "275"},
+        {DXD_SOURCE_DIR "/data/run_set/Bellcanada.txt", 3, "775"},
+        {DXD_SOURCE_DIR "/data/exact_cover_benchmark/bell-06.ec", 1, "203"},
+    };
+    Logger logger("/dev/null", false);
+    for (const Case& c : cases) {
+        auto solver = compileInstance(c.file, c.mode, logger);
+        SparseInstance inst = InstanceLoader::parseText(c.file, c.mode);
+        CHECK(solver->solutionCount == c.count);
+        if (c.file == independent) CHECK(solver->getStore().node(solver->getRoot()).kind == DnnfKind::And);
+
+        std::vector<std::vector<int>> solutions = allSolutions(solver->getStore(), solver->getRoot());
+        CHECK(std::to_string(solutions.size()) == c.count);
+        CHECK(std::all_of(solutions.begin(), solutions.end(), [&](const std::vector<int>& s) { return isExactCover(inst, s); }));
+        std::vector<std::vector<int>> distinct = solutions;
+        std::sort(distinct.begin(), distinct.end());
+        CHECK(std::adjacent_find(distinct.begin(), distinct.end()) == distinct.end());
+
+        // limit：前若干个解与完整枚举的开头一致，超过解数时只枚举全部解
+        std::vector<std::vector<int>> head;
+        DnnfEnumerator limited(solver->getStore(), solver->getRoot());
+        CHECK(limited.forEach([&](const std::vector<int>& rows) {
+            head.push_back(rows);
+            std::sort(head.back().begin(), head.back().end());
+        }, 10) == 10);
+        CHECK(std::equal(head.begin(), head.end(), solutions.begin()));
+        CHECK(DnnfEnumerator(solver->getStore(), solver->getRoot()).forEach([](const std::vector<int>&) {}, 0) == 0);
+        CHECK(DnnfEnumerator(solver->getStore(), solver->getRoot()).forEach([](const std::vector<int>&) {},
+                                                                             solutions.size() + 5) == solutions.size());
+        std::ostringstream text;
+        CHECK(DnnfEnumerator(solver->getStore(), solver->getRoot()).writeTo(text, 3) == 3);
+        const std::string written = text.str();
+        CHECK(std::count(written.begin(), written.end(), '\n') == 3);
+    }
+
+    // 无解实例的根为 FALSE：不产生任何解，之后再取也没有
+    {
+        auto solver = compileInstance(unsat, 1, logger);
+        CHECK(solver->solutionCount == "0");
+        CHECK(solver->getRoot() == DnnfStore::FALSE_ID);
+        DnnfEnumerator e(solver->getStore(), solver->getRoot());
+        std::vector<int> rows{1, 2};
+        CHECK(!e.next(rows));
+        CHECK(!e.next(rows));
+    }
+    // 根为 TRUE：恰有一个空解
+    {
+        DnnfStore store;
+        DnnfEnumerator e(store, DnnfStore::TRUE_ID);
+        std::vector<int> rows{1};
+        CHECK(e.next(rows) && rows.empty());
+        CHECK(!e.next(rows));
+    }
+    fs::remove(independent);
+    fs::remove(linked);
+    fs::remove(unsat);
+}
+
+// 块的规范形式：每块的行与列各自升序，块按行集合排序
+using CanonicalBlocks = std::vector<std::pair<std::vector<int>, std::vector<int>>>;
+static CanonicalBlocks canonicalBlocks(const std::vector<Block>& blocks) {
+    CanonicalBlocks result;
+    for (const Block& b : blocks) {
+        std::vector<int> rows(b.rows.begin(), b.rows.end()), cols(b.cols.begin(), b.cols.end());
+        std::sort(rows.begin(), rows.end());
+        std::sort(cols.begin(), cols.end());
+        result.emplace_back(std::move(rows), std::move(cols));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Clique 与 Bipartite 两种连通图下 getComponentsByETT 得到相同的块：与搜索一样只保留最大的连通分量，
+// 每步随机选一行，删除它以及与它共享列的全部活跃行（覆盖该行），直到没有活跃行，再按相反顺序恢复；
+// 每次删除、恢复之后比较两边的块。多轮随机下降检查 colLiveRows 在删除与恢复之间不漂移
+static void testBipartiteBlocksMatchClique() {
+    std::string linked = (fs::temp_directory_path() / "dxd_unit_test_linked.ec").string();
+    writeLinkedBell03(linked, 8);
+    // bell-08 与 Arnes 的冲突图稠密，下降过程中不分裂（电路也没有 AND 节点），只比较单个分量
+    struct Case { std::string file; int mode; bool splits; };
+    const Case cases[] = {
+        {DXD_SOURCE_DIR "/data/exact_cover_benchmark/bell-08.ec", 1, false},
+        {DXD_SOURCE_DIR "/data/run_set/Arnes.txt", 3, false},
+        {DXD_SOURCE_DIR "/data/exact_cover_benchmark/latin6-blk-00001.ec", 1, true},
+        {linked, 1, true},
+    };
+    for (const Case& c : cases) {
+        const std::string& file = c.file;
+        SparseInstance inst = InstanceLoader::parseText(file, c.mode);
+        DancingMatrix clique(file, c.mode, false, true, ConnectivityGraph::Clique);
+        DancingMatrix bipartite(file, c.mode, false, true, ConnectivityGraph::Bipartite);
+
+        // 两边各保留行数最多的分量
+        std::vector<int> startRows;
+        for (DancingMatrix* dm : {&clique, &bipartite}) {
+            auto& comps = dm->components;
+            auto rowCount = [&](const splaytree::EulerTourTree& t) {
+                return std::count_if(t.vertices.begin(), t.vertices.end(), [&](int v) { return v < dm->ROWS; });
+            };
+            size_t largest = 0;
+            for (size_t i = 1; i < comps.size(); i++) {
+                if (rowCount(*comps[i]) > rowCount(*comps[largest])) largest = i;
+            }
+            std::vector<std::unique_ptr<splaytree::EulerTourTree>> stash;
+            stash.swap(comps);
+            comps.push_back(std::move(stash[largest]));
+            dm->activeSubgraph_ = dm->graph->subgraphOf(comps[0]->getAnyVertex());
+            startRows.clear();
+            for (int v : comps[0]->vertices) {
+                if (v < dm->ROWS) startRows.push_back(v);
+            }
+            std::sort(startRows.begin(), startRows.end());
+        }
+        CHECK(canonicalBlocks(clique.getComponentsByETT()) == canonicalBlocks(bipartite.getComponentsByETT()));
+
+        std::mt19937_64 rng(23);
+        size_t mismatches = 0, splits = 0;
+        for (int walk = 0; walk < 3; walk++) {
+            std::set<int> alive(startRows.begin(), startRows.end());
+            std::vector<std::set<int>> trail;
+            while (!alive.empty()) {
+                auto pick = alive.begin();
+                std::advance(pick, rng() % alive.size());
+                const int r = *pick;
+                std::set<int> deleted;
+                for (int other : alive) {
+                    bool conflict = other == r;
+                    for (uint32_t k = inst.rowOffsets[r]; k < inst.rowOffsets[r + 1] && !conflict; k++) {
+                        const int32_t* b = inst.colIndices.data() + inst.rowOffsets[other];
+                        const int32_t* e = inst.colIndices.data() + inst.rowOffsets[other + 1];
+                        conflict = std::binary_search(b, e, inst.colIndices[k]);
+                    }
+                    if (conflict) deleted.insert(other);
+                }
+                for (int v : deleted) alive.erase(v);
+
+                clique.DecUpdateCC(deleted);
+                bipartite.DecUpdateCC(deleted);
+                CanonicalBlocks expected = canonicalBlocks(clique.getComponentsByETT());
+                mismatches += expected != canonicalBlocks(bipartite.getComponentsByETT());
+                splits += expected.size() > 1;
+                trail.push_back(std::move(deleted));
+            }
+            for (auto it = trail.rbegin(); it != trail.rend(); ++it) {
+                clique.IncUpdateCC(*it);
+                bipartite.IncUpdateCC(*it);
+                mismatches += canonicalBlocks(clique.getComponentsByETT()) != canonicalBlocks(bipartite.getComponentsByETT());
+            }
+            CHECK(clique.components.size() == 1 && bipartite.components.size() == 1);
+        }
+        CHECK(mismatches == 0);
+        CHECK(!c.splits || splits > 0);
+        if (mismatches) std::cerr << c.file << ": " << mismatches << " 次分块不一致" << std::endl;
+    }
+    fs::remove(linked);
+}
+
+// HDT 分层：随机图逐条删边，每步与并查集比较连通分量，并检查分层不变量——
+// F_i 中每棵树至多 n / 2^i 个顶点，层级为 i 的非树边两端在 F_i 中连通
+static void testHdtLevels() {
+    using splaytree::EulerTourTree;
+    const int n = 256;
+    std::mt19937_64 rng(22);
+    // 16 个稠密簇，簇间再连少量边，删边时会反复找替代边和分裂
+    std::set<std::pair<int, int>> edgeSet;
+    for (int i = 0; i < 6 * n; i++) {
+        int u = rng() % n;
+        int v = (i % 8 == 0) ? rng() % n : (u / 16) * 16 + rng() % 16;
+        if (u != v) edgeSet.emplace(std::min(u, v), std::max(u, v));
+    }
+    std::vector<std::pair<int, int>> edges(edgeSet.begin(), edgeSet.end());
+
+    std::vector<EulerTourTree*> index;
+    std::vector<std::unique_ptr<EulerTourTree>> trees;
+    for (int v = 0; v < n; v++) {
+        trees.push_back(std::make_unique<EulerTourTree>(v));
+        trees.back()->attachIndex(&index);
+        trees.back()->addVertex(v);
+    }
+    std::shuffle(edges.begin(), edges.end(), rng);
+    for (auto [u, v] : edges) {
+        if (index[u] != index[v]) index[u]->link(u, v, index[v]);
+        else index[u]->addNonTreeEdge(splaytree::Edge(u, v));
+    }
+
+    auto levelsHold = [&](EulerTourTree& t) {
+        for (size_t i = 0; i < t.upperLevels.size(); i++) {
+            const int level = static_cast<int>(i) + 1;
+            for (auto& [x, nodes] : t.upperLevels[i].nodes) {
+                int size = EulerTourTree::findRoot(nodes.at(x))->size;
+                if ((size + 2) / 3 > (n >> level)) return false;
+            }
+            for (auto& [x, adj] : t.upperLevels[i].nonTreeAdj) {
+                for (int w : adj) {
+                    if (EulerTourTree::findRoot(t.levelVertex(level, x)) != EulerTourTree::findRoot(t.levelVertex(level, w))) return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    std::shuffle(edges.begin(), edges.end(), rng);
+    size_t partitionErrors = 0, levelErrors = 0, maxLevels = 0;
+    for (size_t k = 0; k < edges.size(); k++) {
+        auto [u, v] = edges[k];
+        EulerTourTree* tree = index[u];
+        if (tree->isTreeEdge(u, v)) {
+            auto split = tree->cutWithReplacement(u, v);
+            if (split) trees.push_back(std::move(split));
+        } else {
+            tree->removeNonTreeEdge(splaytree::Edge(u, v));
+        }
+
+        std::vector<int> parent(n);
+        std::iota(parent.begin(), parent.end(), 0);
+        std::function<int(int)> find = [&](int x) { return parent[x] == x ? x : parent[x] = find(parent[x]); };
+        for (size_t j = k + 1; j < edges.size(); j++) parent[find(edges[j].first)] = find(edges[j].second);
+        std::map<int, EulerTourTree*> treeOfRoot;
+        std::map<EulerTourTree*, int> rootOfTree;
+        for (int x = 0; x < n; x++) {
+            auto a = treeOfRoot.emplace(find(x), index[x]).first;
+            auto b = rootOfTree.emplace(index[x], find(x)).first;
+            partitionErrors += a->second != index[x] || b->second != find(x);
+        }
+        for (auto& t : trees) {
+            levelErrors += !levelsHold(*t);
+            maxLevels = std::max(maxLevels, t->upperLevels.size());
+        }
+    }
+    CHECK(partitionErrors == 0);
+    CHECK(levelErrors == 0);
+    CHECK(maxLevels > 0);
+    for (auto& t : trees) CHECK(t->isEmpty() || (t->vertices.size() == 1 && t->getNonTreeEdges().empty()));
+}
+
+// 回收的空树：清空内容并注销路由，下次 acquire 取回同一对象，外层哈希表保留桶数组
+static void testTreeShellRecycling() {
+    using splaytree::EulerTourTree;
+    // 先取空前面测试留在空闲表里的树（每线程至多 256 棵）
+    std::vector<std::unique_ptr<EulerTourTree>> drained;
+    for (int i = 0; i < 256; i++) drained.push_back(EulerTourTree::acquire(-1));
+
+    std::vector<EulerTourTree*> index;
+    std::vector<std::unique_ptr<EulerTourTree>> trees;
+    for (int v = 0; v < 100; v++) {
+        trees.push_back(EulerTourTree::acquire(v));
+        trees.back()->attachIndex(&index);
+        trees.back()->addVertex(v);
+    }
+    for (int v = 1; v < 100; v++) index[0]->link(v - 1, v, index[v]);
+    for (int v = 2; v < 100; v++) index[0]->addNonTreeEdge(splaytree::Edge(v - 2, v));
+    CHECK(index[0] == trees[0].get() && index[0]->vertices.size() == 100);
+
+    EulerTourTree* shell = trees[0].get();
+    const size_t buckets = shell->vertices.bucket_count();
+    EulerTourTree::recycle(std::move(trees[0]));
+    CHECK(std::all_of(index.begin(), index.end(), [](EulerTourTree* t) { return t == nullptr; }));
+
+    auto reused = EulerTourTree::acquire(5);
+    CHECK(reused.get() == shell);
+    CHECK(reused->isEmpty() && reused->root == nullptr && reused->vertexIndex == nullptr && reused->upperLevels.empty());
+    CHECK(reused->treeId == 5 && reused->vertices.bucket_count() == buckets);
+    reused->attachIndex(&index);
+    reused->addVertex(7);
+    CHECK(index[7] == shell && reused->getVertexDegree(7) == 0);
+}
+
+int main() {
+    testColumnBucketsSparseColumns();
+    testCountCacheBudgetAfterChurn();
+    testCountCacheHashCollision();
+    testExportedNnfModelCount();
+    testSemiringSearchMatchesCircuit();
+    testBigCountArithmetic();
+    testBigCountAgreesWithModCount();
+    testExactAndModularSearchAgree();
+    testBinaryInstanceValidation();
+    testDnnfBinaryValidation();
+    testDnnfQueryMatchesEnumeration();
+    testDnnfSamplerUniform();
+    testDnnfEnumerator();
+    testBipartiteBlocksMatchClique();
+    testHdtLevels();
+    testTreeShellRecycling();
+
+    if (failures) {
+        std::cerr << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "全部检查通过" << std::endl;
+    return 0;
+}